@@ -0,0 +1,40 @@
+// include/Base64.h
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Standard base64 (RFC 4648) for binary blobs carried in JSON payloads
+inline std::string base64Encode(const uint8_t* data, size_t len) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve(((len + 2) / 3) * 4);
+
+    size_t i = 0;
+    for (; i + 2 < len; i += 3) {
+        uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(alphabet[(triple >> 18) & 63]);
+        out.push_back(alphabet[(triple >> 12) & 63]);
+        out.push_back(alphabet[(triple >> 6) & 63]);
+        out.push_back(alphabet[triple & 63]);
+    }
+
+    if (i < len) {
+        uint32_t triple = data[i] << 16;
+        if (i + 1 < len) {
+            triple |= data[i + 1] << 8;
+        }
+        out.push_back(alphabet[(triple >> 18) & 63]);
+        out.push_back(alphabet[(triple >> 12) & 63]);
+        out.push_back(i + 1 < len ? alphabet[(triple >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+
+    return out;
+}
+
+#endif // BASE64_H
\ No newline at end of file
@@ -0,0 +1,171 @@
+// src/CapacityModel.cpp
+#include "CapacityModel.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Weight of the newest CPU sample
+    const double kSmoothing = 0.3;
+
+    // Frames flowing but below this share of the configured rate means
+    // the encoder is not keeping up
+    const double kEncoderSaturation = 0.8;
+}
+
+const char* admissionDecisionToString(AdmissionDecision decision) {
+    switch (decision) {
+    case AdmissionDecision::ACCEPT: return "accept";
+    case AdmissionDecision::DEGRADE: return "degrade";
+    case AdmissionDecision::REJECT: return "reject";
+    default: return "unknown";
+    }
+}
+
+// Constructor
+CapacityModel::CapacityModel(const DeviceConfig::CapacitySettings& capacitySettings,
+    const DeviceConfig::StreamSettings& streamSettings)
+    : settings(capacitySettings),
+    stream(streamSettings),
+    cpuPct(0.0),
+    mainKbps(streamSettings.bitrateKbps),
+    encoderSaturated(false),
+    lastBusyTicks(0),
+    lastTotalTicks(0) {
+}
+
+// Sampling
+void CapacityModel::sample(const StreamInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    readCpu();
+
+    // Configured bitrate until the encoder reports one
+    if (info.bitrateKbps > 0.0) {
+        mainKbps = info.bitrateKbps;
+    }
+    encoderSaturated = info.fps > 0.0 && info.fps < stream.fps * kEncoderSaturation;
+}
+
+void CapacityModel::readCpu() {
+    FILE* file = fopen("/proc/stat", "r");
+    if (!file) {
+        return;
+    }
+
+    unsigned long long user = 0, nice = 0, system = 0, idle = 0;
+    unsigned long long iowait = 0, irq = 0, softirq = 0, steal = 0;
+    int fields = fscanf(file, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+        &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    fclose(file);
+    if (fields < 4) {
+        return;
+    }
+
+    uint64_t total = user + nice + system + idle + iowait + irq + softirq + steal;
+    uint64_t busy = total - idle - iowait;
+
+    // First call only primes the counters
+    if (lastTotalTicks != 0 && total > lastTotalTicks) {
+        double pct = 100.0 * (busy - lastBusyTicks) / (total - lastTotalTicks);
+        cpuPct += kSmoothing * (pct - cpuPct);
+    }
+    lastBusyTicks = busy;
+    lastTotalTicks = total;
+}
+
+// Admission
+CapacityModel::Load CapacityModel::projectedLoad(Clock::time_point now) const {
+    Load load;
+    load.cpuPct = cpuPct;
+    load.uplinkUsedKbps = 0.0;
+    load.viewers = static_cast<int>(sessions.size());
+
+    // Sessions newer than the reservation window are not in the CPU
+    // samples yet
+    const Clock::duration settling = std::chrono::seconds(settings.reservationSecs);
+    for (const auto& entry : sessions) {
+        const Session& session = entry.second;
+        load.uplinkUsedKbps += session.substream ? settings.substreamBitrateKbps : mainKbps;
+        if (now - session.at < settling) {
+            load.cpuPct += settings.cpuPerViewerPct;
+        }
+    }
+    return load;
+}
+
+int CapacityModel::slotsFor(const Load& load, double streamKbps) const {
+    int slots = settings.maxViewers - load.viewers;
+
+    if (settings.cpuPerViewerPct > 0.0) {
+        slots = std::min(slots, static_cast<int>(
+            std::floor((settings.cpuLimitPct - load.cpuPct) / settings.cpuPerViewerPct)));
+    }
+
+    if (streamKbps > 0.0) {
+        slots = std::min(slots, static_cast<int>(
+            std::floor((settings.uplinkKbps - load.uplinkUsedKbps) / streamKbps)));
+    }
+
+    // Packet buffers for the new viewers must fit the pool budget
+    size_t budget = MemoryAccounting::getBudget(MemoryTag::PACKETS);
+    if (MemoryAccounting::underPressure()) {
+        slots = 0;
+    }
+    else if (budget != 0 && settings.memoryPerViewerKb > 0) {
+        size_t used = MemoryAccounting::current(MemoryTag::PACKETS);
+        size_t free = budget > used ? budget - used : 0;
+        slots = std::min(slots, static_cast<int>(free / (static_cast<size_t>(settings.memoryPerViewerKb) * 1024)));
+    }
+
+    return std::max(slots, 0);
+}
+
+AdmissionDecision CapacityModel::admit(const std::string& viewerId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Asking again (e.g. after a reconnect) must not count the viewer twice
+    sessions.erase(viewerId);
+
+    Clock::time_point now = Clock::now();
+    Load load = projectedLoad(now);
+
+    // A struggling encoder cannot promise the full-rate stream
+    if (!encoderSaturated && slotsFor(load, mainKbps) > 0) {
+        sessions[viewerId] = Session{ now, false };
+        return AdmissionDecision::ACCEPT;
+    }
+
+    if (!settings.substreamUrl.empty() && slotsFor(load, settings.substreamBitrateKbps) > 0) {
+        sessions[viewerId] = Session{ now, true };
+        return AdmissionDecision::DEGRADE;
+    }
+
+    return AdmissionDecision::REJECT;
+}
+
+bool CapacityModel::release(const std::string& viewerId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessions.erase(viewerId) > 0;
+}
+
+cJSON* CapacityModel::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Clock::time_point now = Clock::now();
+    Load load = projectedLoad(now);
+    int main = encoderSaturated ? 0 : slotsFor(load, mainKbps);
+    int sub = settings.substreamUrl.empty() ? 0 : slotsFor(load, settings.substreamBitrateKbps);
+
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "state", main > 0 ? "ok" : (sub > 0 ? "degraded" : "full"));
+    cJSON_AddNumberToObject(json, "cpu_pct", std::round(cpuPct));
+    cJSON_AddNumberToObject(json, "uplink_kbps", settings.uplinkKbps);
+    cJSON_AddNumberToObject(json, "uplink_used_kbps", std::round(load.uplinkUsedKbps));
+    cJSON_AddNumberToObject(json, "viewers", load.viewers);
+    cJSON_AddNumberToObject(json, "main_slots", main);
+    cJSON_AddNumberToObject(json, "sub_slots", sub);
+    cJSON_AddBoolToObject(json, "encoder_saturated", encoderSaturated);
+    return json;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+// include/CapacityModel.h
+#ifndef CAPACITY_MODEL_H
+#define CAPACITY_MODEL_H
+
+#include <mutex>
+#include <map>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+#include "DeviceConfig.h"
+#include "StreamStats.h"
+
+// Outcome of admitting one more viewer
+enum class AdmissionDecision {
+    ACCEPT,         // Main stream
+    DEGRADE,        // Substream only
+    REJECT
+};
+
+const char* admissionDecisionToString(AdmissionDecision decision);
+
+// Estimates whether the device can take another viewer.
+//
+// Each viewer costs a fixed CPU share for packetisation and its stream's
+// bitrate on the uplink; memory comes from the packet pool. sample() is
+// fed from the main loop with system CPU (from /proc/stat) and the live
+// stream counters. admit() checks the cost of one more viewer against
+// what is left, first for the main stream and then for the substream.
+// Each admitted viewer holds a session until release() is called for it
+// when the viewer disconnects. A new session is also charged its CPU
+// share for reservation_secs, until the CPU samples can reflect it, so a
+// burst of requests cannot all claim the same headroom.
+class CapacityModel {
+public:
+    CapacityModel(const DeviceConfig::CapacitySettings& settings,
+        const DeviceConfig::StreamSettings& stream);
+
+    // Main loop, once per tick
+    void sample(const StreamInfo& info);
+
+    // Signaling thread; opens a session for the viewer unless the answer
+    // is REJECT. A repeat request from the same viewer replaces its session.
+    AdmissionDecision admit(const std::string& viewerId);
+
+    // The viewer's session ended; false if it held none
+    bool release(const std::string& viewerId);
+
+    // {"state": "ok"|"degraded"|"full", "cpu_pct": n, "uplink_kbps": n, ...}
+    cJSON* toJson() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Load {
+        double cpuPct;
+        double uplinkUsedKbps;
+        int viewers;
+    };
+
+    struct Session {
+        Clock::time_point at;
+        bool substream;
+    };
+
+    DeviceConfig::CapacitySettings settings;
+    DeviceConfig::StreamSettings stream;
+
+    mutable std::mutex mutex;
+    double cpuPct;
+    double mainKbps;                // Measured main-stream bitrate
+    bool encoderSaturated;
+    std::map<std::string, Session> sessions;
+
+    // /proc/stat deltas
+    uint64_t lastBusyTicks;
+    uint64_t lastTotalTicks;
+
+    void readCpu();
+    Load projectedLoad(Clock::time_point now) const;
+    int slotsFor(const Load& load, double streamKbps) const;
+};
+
+#endif // CAPACITY_MODEL_H
\ No newline at end of file
@@ -3,18 +3,128 @@
 #define DEVICE_CONFIG_H
 
 #include <string>
+#include <vector>
 #include <cjson/cJSON.h>
 #include <fstream>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
+#include "ThreadPolicy.h"
+
 class DeviceConfig {
 public:
     std::string deviceId;
     std::string macAddress;
     std::string cloudSerialNumber;
     std::string rtspUrl;
-    uint16_t defaultRtpPort;
+    uint16_t defaultRtpPort = 5004;
+
+    // Encoder/stream description advertised in STREAM_INFO
+    struct StreamSettings {
+        std::string codec = "H264";
+        int width = 1920;
+        int height = 1080;
+        int fps = 25;
+        int gop = 50;
+        int bitrateKbps = 4000;
+    };
+    StreamSettings stream;
+
+    // On-device motion detection over a downscaled luma plane
+    struct MotionSettings {
+        bool enabled = false;
+        std::string source = "/tmp/kinnode-luma.fifo";  // Raw 8-bit Y frames
+        int width = 320;
+        int height = 180;
+        int fps = 5;
+        int pixelThreshold = 12;        // Mean per-pixel difference for a busy block
+        double areaThreshold = 0.01;    // Fraction of busy blocks that counts as motion
+        int holdMs = 3000;              // Quiet time before motion ends
+    };
+    MotionSettings motion;
+
+    // JPEG snapshots answered from REQUEST {"action": "snapshot"}
+    struct SnapshotSettings {
+        std::string source = "/tmp/kinnode-snapshot.yuv";  // Latest raw I420 frame
+        int width = 1920;
+        int height = 1080;
+        int maxWidth = 480;
+        int quality = 75;
+        int cacheSecs = 5;
+    };
+    SnapshotSettings snapshot;
+
+    // Viewer admission: per-viewer costs against what the device has
+    struct CapacitySettings {
+        int uplinkKbps = 8000;              // Available to viewer streams
+        int cpuLimitPct = 85;
+        double cpuPerViewerPct = 4.0;       // Packetisation and send cost
+        int maxViewers = 8;
+        int memoryPerViewerKb = 256;        // Packet pool share
+        std::string substreamUrl;           // Offered when degraded; empty = none
+        int substreamBitrateKbps = 512;
+        int reservationSecs = 15;           // New viewer's CPU share projected until sampled
+    };
+    CapacitySettings capacity;
+
+    // Gateway relay mode: forward camera RTP to many viewers
+    struct RelaySettings {
+        bool enabled = false;
+        int shards = 0;                     // 0 = one per CPU
+        std::string bindAddress = "0.0.0.0";
+        std::string publicAddress;          // Advertised to peers; empty = bindAddress
+        int portBase = 40000;               // One port per camera
+        int portCount = 1000;
+        int maxViewersPerSource = 64;
+        bool fec = false;                   // FlexFEC, sized from viewers' RTCP loss
+        int fecPayloadType = 118;
+    };
+    RelaySettings relay;
+
+    // Signaling link: where to go when the current server stays slow
+    struct SignalingSettings {
+        std::vector<std::string> fallbackUrls;  // Tried in turn after the primary
+        int maxRttMs = 1500;
+        int maxChokedPct = 50;              // Of each second
+        int degradedSecs = 30;              // Sustained (or disconnected) before moving
+    };
+    SignalingSettings signaling;
+
+    // Signaling frame capture for reproducing field issues; empty path = off
+    struct CaptureSettings {
+        std::string path;
+        int fileKb = 8192;                  // Each file is mapped at this size
+        int files = 4;                      // Live file plus rotated ones
+    };
+    CaptureSettings capture;
+
+    // Logging: empty file means stderr
+    std::string logFile;
+    std::string logLevel = "info";
+
+    // Per-subsystem heap budgets in kB; 0 = unlimited
+    struct MemoryBudgets {
+        int jsonKb = 0;
+        int websocketKb = 0;
+        int queuesKb = 0;
+        int packetsKb = 0;
+    };
+    MemoryBudgets memory;
+
+    // Scheduling per thread role; background work yields to the rest
+    ThreadPolicy mainThread = ThreadPolicy("rtc-main");
+    ThreadPolicy signalingThread = ThreadPolicy("rtc-signaling");
+    ThreadPolicy motionThread = ThreadPolicy("rtc-motion", 5);
+    ThreadPolicy logThread = ThreadPolicy("rtc-log", 5);
+    ThreadPolicy diagnosticsThread = ThreadPolicy("rtc-diag", 10);
+    ThreadPolicy snapshotThread = ThreadPolicy("rtc-snapshot", 10);
+    ThreadPolicy relayThread = ThreadPolicy("rtc-relay");     // Per shard, name suffixed "-<n>"
+    bool lockMemory = false;
+
+    // Hang detection: restart when a watched thread stalls this long (0 = off)
+    int watchdogTimeoutMs = 10000;
+    std::string hangReportPath = "/tmp/kinnode-hang-report.txt";
 
     // Load configuration from a JSON file
     static DeviceConfig loadFromFile(const std::string& configPath) {
@@ -46,13 +156,170 @@ public:
         config.deviceId = deviceId && deviceId->valuestring ?
             deviceId->valuestring : generateDeviceId();
 
-        // Continue parsing other fields similarly
+        config.macAddress = stringField(configJson, "mac_address", config.macAddress);
+        config.cloudSerialNumber = stringField(configJson, "csn", config.cloudSerialNumber);
+        config.rtspUrl = stringField(configJson, "rtsp_url", config.rtspUrl);
+        config.defaultRtpPort = static_cast<uint16_t>(
+            numberField(configJson, "rtp_port", config.defaultRtpPort));
+
+        config.logFile = stringField(configJson, "log_file", config.logFile);
+        config.logLevel = stringField(configJson, "log_level", config.logLevel);
+
+        cJSON* memory = cJSON_GetObjectItemCaseSensitive(configJson, "memory_budget_kb");
+        if (cJSON_IsObject(memory)) {
+            config.memory.jsonKb = numberField(memory, "json", config.memory.jsonKb);
+            config.memory.websocketKb = numberField(memory, "websocket", config.memory.websocketKb);
+            config.memory.queuesKb = numberField(memory, "queues", config.memory.queuesKb);
+            config.memory.packetsKb = numberField(memory, "packets", config.memory.packetsKb);
+        }
+
+        cJSON* threads = cJSON_GetObjectItemCaseSensitive(configJson, "threads");
+        if (cJSON_IsObject(threads)) {
+            threadPolicyField(threads, "main", config.mainThread);
+            threadPolicyField(threads, "signaling", config.signalingThread);
+            threadPolicyField(threads, "motion", config.motionThread);
+            threadPolicyField(threads, "log", config.logThread);
+            threadPolicyField(threads, "diagnostics", config.diagnosticsThread);
+            threadPolicyField(threads, "snapshot", config.snapshotThread);
+            threadPolicyField(threads, "relay", config.relayThread);
+        }
+        cJSON* lockMemory = cJSON_GetObjectItemCaseSensitive(configJson, "mlockall");
+        config.lockMemory = cJSON_IsBool(lockMemory) ? cJSON_IsTrue(lockMemory) : config.lockMemory;
+
+        cJSON* watchdog = cJSON_GetObjectItemCaseSensitive(configJson, "watchdog");
+        if (cJSON_IsObject(watchdog)) {
+            config.watchdogTimeoutMs = numberField(watchdog, "timeout_ms", config.watchdogTimeoutMs);
+            config.hangReportPath = stringField(watchdog, "report_path", config.hangReportPath);
+        }
+
+        cJSON* motion = cJSON_GetObjectItemCaseSensitive(configJson, "motion");
+        if (cJSON_IsObject(motion)) {
+            cJSON* enabled = cJSON_GetObjectItemCaseSensitive(motion, "enabled");
+            config.motion.enabled = cJSON_IsBool(enabled) ? cJSON_IsTrue(enabled) : true;
+            config.motion.source = stringField(motion, "source", config.motion.source);
+            config.motion.width = numberField(motion, "width", config.motion.width);
+            config.motion.height = numberField(motion, "height", config.motion.height);
+            config.motion.fps = numberField(motion, "fps", config.motion.fps);
+            config.motion.pixelThreshold = numberField(motion, "pixel_threshold", config.motion.pixelThreshold);
+            config.motion.areaThreshold = doubleField(motion, "area_threshold", config.motion.areaThreshold);
+            config.motion.holdMs = numberField(motion, "hold_ms", config.motion.holdMs);
+        }
+
+        cJSON* snapshot = cJSON_GetObjectItemCaseSensitive(configJson, "snapshot");
+        if (cJSON_IsObject(snapshot)) {
+            config.snapshot.source = stringField(snapshot, "source", config.snapshot.source);
+            config.snapshot.width = numberField(snapshot, "width", config.snapshot.width);
+            config.snapshot.height = numberField(snapshot, "height", config.snapshot.height);
+            config.snapshot.maxWidth = numberField(snapshot, "max_width", config.snapshot.maxWidth);
+            config.snapshot.quality = numberField(snapshot, "quality", config.snapshot.quality);
+            config.snapshot.cacheSecs = numberField(snapshot, "cache_secs", config.snapshot.cacheSecs);
+        }
+
+        cJSON* stream = cJSON_GetObjectItemCaseSensitive(configJson, "stream");
+        if (cJSON_IsObject(stream)) {
+            config.stream.codec = stringField(stream, "codec", config.stream.codec);
+            config.stream.width = numberField(stream, "width", config.stream.width);
+            config.stream.height = numberField(stream, "height", config.stream.height);
+            config.stream.fps = numberField(stream, "fps", config.stream.fps);
+            config.stream.gop = numberField(stream, "gop", config.stream.gop);
+            config.stream.bitrateKbps = numberField(stream, "bitrate_kbps", config.stream.bitrateKbps);
+        }
+
+        cJSON* capacity = cJSON_GetObjectItemCaseSensitive(configJson, "capacity");
+        if (cJSON_IsObject(capacity)) {
+            config.capacity.uplinkKbps = numberField(capacity, "uplink_kbps", config.capacity.uplinkKbps);
+            config.capacity.cpuLimitPct = numberField(capacity, "cpu_limit_pct", config.capacity.cpuLimitPct);
+            config.capacity.cpuPerViewerPct = doubleField(capacity, "cpu_per_viewer_pct", config.capacity.cpuPerViewerPct);
+            config.capacity.maxViewers = numberField(capacity, "max_viewers", config.capacity.maxViewers);
+            config.capacity.memoryPerViewerKb = numberField(capacity, "memory_per_viewer_kb", config.capacity.memoryPerViewerKb);
+            config.capacity.substreamUrl = stringField(capacity, "substream_url", config.capacity.substreamUrl);
+            config.capacity.substreamBitrateKbps = numberField(capacity, "substream_bitrate_kbps", config.capacity.substreamBitrateKbps);
+            config.capacity.reservationSecs = numberField(capacity, "reservation_secs", config.capacity.reservationSecs);
+        }
+
+        cJSON* relay = cJSON_GetObjectItemCaseSensitive(configJson, "relay");
+        if (cJSON_IsObject(relay)) {
+            cJSON* enabled = cJSON_GetObjectItemCaseSensitive(relay, "enabled");
+            config.relay.enabled = cJSON_IsBool(enabled) ? cJSON_IsTrue(enabled) : config.relay.enabled;
+            config.relay.shards = numberField(relay, "shards", config.relay.shards);
+            config.relay.bindAddress = stringField(relay, "bind_address", config.relay.bindAddress);
+            config.relay.publicAddress = stringField(relay, "public_address", config.relay.publicAddress);
+            config.relay.portBase = numberField(relay, "port_base", config.relay.portBase);
+            config.relay.portCount = numberField(relay, "port_count", config.relay.portCount);
+            config.relay.maxViewersPerSource = numberField(relay, "max_viewers_per_source", config.relay.maxViewersPerSource);
+            cJSON* fec = cJSON_GetObjectItemCaseSensitive(relay, "fec");
+            config.relay.fec = cJSON_IsBool(fec) ? cJSON_IsTrue(fec) : config.relay.fec;
+            config.relay.fecPayloadType = numberField(relay, "fec_payload_type", config.relay.fecPayloadType);
+        }
+
+        cJSON* signaling = cJSON_GetObjectItemCaseSensitive(configJson, "signaling");
+        if (cJSON_IsObject(signaling)) {
+            cJSON* url = nullptr;
+            cJSON_ArrayForEach(url, cJSON_GetObjectItemCaseSensitive(signaling, "fallback_urls")) {
+                if (cJSON_IsString(url) && url->valuestring) {
+                    config.signaling.fallbackUrls.push_back(url->valuestring);
+                }
+            }
+            config.signaling.maxRttMs = numberField(signaling, "max_rtt_ms", config.signaling.maxRttMs);
+            config.signaling.maxChokedPct = numberField(signaling, "max_choked_pct", config.signaling.maxChokedPct);
+            config.signaling.degradedSecs = numberField(signaling, "degraded_secs", config.signaling.degradedSecs);
+        }
+
+        cJSON* capture = cJSON_GetObjectItemCaseSensitive(configJson, "signaling_capture");
+        if (cJSON_IsObject(capture)) {
+            config.capture.path = stringField(capture, "path", config.capture.path);
+            config.capture.fileKb = numberField(capture, "file_kb", config.capture.fileKb);
+            config.capture.files = numberField(capture, "files", config.capture.files);
+        }
 
         cJSON_Delete(configJson);
         return config;
     }
 
 private:
+    // Field helpers: fall back to the default when missing or mistyped
+    static std::string stringField(const cJSON* object, const char* key, const std::string& fallback) {
+        cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+        return cJSON_IsString(item) && item->valuestring ? item->valuestring : fallback;
+    }
+
+    static int numberField(const cJSON* object, const char* key, int fallback) {
+        cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+        return cJSON_IsNumber(item) ? item->valueint : fallback;
+    }
+
+    static double doubleField(const cJSON* object, const char* key, double fallback) {
+        cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+        return cJSON_IsNumber(item) ? item->valuedouble : fallback;
+    }
+
+    // {"name": "...", "cpus": [1, 2], "policy": "fifo"|"other", "priority": n, "nice": n}
+    static void threadPolicyField(const cJSON* threads, const char* key, ThreadPolicy& policy) {
+        cJSON* item = cJSON_GetObjectItemCaseSensitive(threads, key);
+        if (!cJSON_IsObject(item)) {
+            return;
+        }
+
+        policy.name = stringField(item, "name", policy.name);
+
+        cJSON* cpus = cJSON_GetObjectItemCaseSensitive(item, "cpus");
+        if (cJSON_IsArray(cpus)) {
+            policy.cpus.clear();
+            cJSON* cpu;
+            cJSON_ArrayForEach(cpu, cpus) {
+                if (cJSON_IsNumber(cpu)) {
+                    policy.cpus.push_back(cpu->valueint);
+                }
+            }
+        }
+
+        std::string scheduling = stringField(item, "policy",
+            policy.scheduling == SchedulingClass::FIFO ? "fifo" : "other");
+        policy.scheduling = scheduling == "fifo" ? SchedulingClass::FIFO : SchedulingClass::OTHER;
+        policy.priority = numberField(item, "priority", policy.priority);
+        policy.nice = numberField(item, "nice", policy.nice);
+    }
+
     // Generate a unique device ID if not provided
     static std::string generateDeviceId() {
         // Generate a semi-unique ID based on MAC or random number
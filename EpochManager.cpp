@@ -0,0 +1,138 @@
+// src/EpochManager.cpp
+#include "EpochManager.h"
+#include <stdexcept>
+
+// Per-thread registration; returns the slot to the pool on thread exit
+struct EpochThreadState {
+    EpochManager::ThreadSlot* slot = nullptr;
+    unsigned int depth = 0;
+
+    ~EpochThreadState() {
+        if (slot) {
+            EpochManager::instance().releaseSlot(slot);
+        }
+    }
+};
+
+namespace {
+    thread_local EpochThreadState t_epochState;
+}
+
+EpochManager& EpochManager::instance() {
+    static EpochManager manager;
+    return manager;
+}
+
+EpochManager::EpochManager()
+    : globalEpoch(kFirstEpoch) {
+    for (size_t i = 0; i < kMaxThreads; i++) {
+        slots[i].epoch.store(kQuiescentEpoch, std::memory_order_relaxed);
+        slots[i].inUse.store(false, std::memory_order_relaxed);
+    }
+}
+
+EpochManager::~EpochManager() {
+    // Process teardown: no readers remain
+    for (const auto& object : retired) {
+        object.deleter(object.ptr);
+    }
+}
+
+EpochManager::ThreadSlot& EpochManager::localSlot() {
+    if (t_epochState.slot) {
+        return *t_epochState.slot;
+    }
+
+    // One-time registration, off the steady-state read path
+    for (size_t i = 0; i < kMaxThreads; i++) {
+        bool expected = false;
+        if (slots[i].inUse.compare_exchange_strong(expected, true)) {
+            t_epochState.slot = &slots[i];
+            return slots[i];
+        }
+    }
+
+    throw std::runtime_error("EpochManager: too many reader threads");
+}
+
+void EpochManager::releaseSlot(ThreadSlot* slot) {
+    slot->epoch.store(kQuiescentEpoch, std::memory_order_release);
+    slot->inUse.store(false, std::memory_order_release);
+}
+
+// Reader Side
+void EpochManager::enter() {
+    if (t_epochState.depth++ > 0) {
+        return;
+    }
+
+    // Park the slot at the lowest epoch before sampling the global one, so
+    // a concurrent reclaim() can never miss a reader that is still entering.
+    // Wait-free: a fixed three operations regardless of writer activity.
+    ThreadSlot& slot = localSlot();
+    slot.epoch.store(kEnteringEpoch, std::memory_order_seq_cst);
+    slot.epoch.store(globalEpoch.load(std::memory_order_seq_cst),
+        std::memory_order_seq_cst);
+}
+
+void EpochManager::exit() {
+    if (--t_epochState.depth > 0) {
+        return;
+    }
+
+    t_epochState.slot->epoch.store(kQuiescentEpoch, std::memory_order_release);
+}
+
+// Writer Side
+void EpochManager::retire(void* ptr, Deleter deleter) {
+    if (!ptr) {
+        return;
+    }
+
+    bool shouldReclaim;
+    {
+        std::lock_guard<std::mutex> lock(retireMutex);
+
+        // Readers that entered before this point may still hold ptr;
+        // bumping the epoch lets later readers be told apart
+        uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_acq_rel);
+        retired.push_back(RetiredObject{ ptr, deleter, epoch });
+        shouldReclaim = retired.size() >= kReclaimThreshold;
+    }
+
+    if (shouldReclaim) {
+        reclaim();
+    }
+}
+
+void EpochManager::reclaim() {
+    // Oldest epoch any active reader may be running in
+    uint64_t minActive = globalEpoch.load(std::memory_order_seq_cst);
+    for (size_t i = 0; i < kMaxThreads; i++) {
+        uint64_t epoch = slots[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch != kQuiescentEpoch && epoch < minActive) {
+            minActive = epoch;
+        }
+    }
+
+    std::vector<RetiredObject> freeable;
+    {
+        std::lock_guard<std::mutex> lock(retireMutex);
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < minActive) {
+                freeable.push_back(retired[i]);
+            }
+            else {
+                retired[kept++] = retired[i];
+            }
+        }
+        retired.resize(kept);
+    }
+
+    // Run deleters outside the lock
+    for (const auto& object : freeable) {
+        object.deleter(object.ptr);
+    }
+}
\ No newline at end of file
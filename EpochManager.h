@@ -0,0 +1,85 @@
+// include/EpochManager.h
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Epoch-based reclamation for lock-free readers.
+//
+// Readers wrap their accesses in an EpochGuard (two atomic operations, no
+// locks). Writers unlink an object and hand it to retire(); it is freed
+// only once every thread that could still observe it has left its guard.
+class EpochManager {
+public:
+    typedef void (*Deleter)(void*);
+
+    static EpochManager& instance();
+
+    // Reader side
+    void enter();
+    void exit();
+
+    // Writer side
+    void retire(void* ptr, Deleter deleter);
+
+    template <typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // Free everything no reader can still reference
+    void reclaim();
+
+    ~EpochManager();
+
+private:
+    EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    static const size_t kMaxThreads = 256;
+    static const size_t kReclaimThreshold = 64;
+
+    static const uint64_t kQuiescentEpoch = 0;
+    static const uint64_t kEnteringEpoch = 1;
+    static const uint64_t kFirstEpoch = 2;
+
+    // One cache line per thread so announcing an epoch never false-shares
+    struct alignas(64) ThreadSlot {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> inUse;
+    };
+
+    struct RetiredObject {
+        void* ptr;
+        Deleter deleter;
+        uint64_t epoch;
+    };
+
+    ThreadSlot slots[kMaxThreads];
+    std::atomic<uint64_t> globalEpoch;
+
+    std::mutex retireMutex;
+    std::vector<RetiredObject> retired;
+
+    ThreadSlot& localSlot();
+    void releaseSlot(ThreadSlot* slot);
+
+    friend struct EpochThreadState;
+};
+
+// RAII reader critical section; nests freely
+class EpochGuard {
+public:
+    EpochGuard() { EpochManager::instance().enter(); }
+    ~EpochGuard() { EpochManager::instance().exit(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif // EPOCH_MANAGER_H
\ No newline at end of file
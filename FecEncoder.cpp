@@ -0,0 +1,158 @@
+// src/FecEncoder.cpp
+#include "FecEncoder.h"
+#include "RtpPacket.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    // Loss thresholds and the protection each buys: below the first,
+    // NACK alone is cheaper than constant parity
+    struct ProtectionStep {
+        double loss;
+        int groupSize;
+    };
+
+    const ProtectionStep kSteps[] = {
+        { 0.005, 0 },
+        { 0.02, 10 },
+        { 0.05, 5 },
+        { 0.10, 3 },
+    };
+    const int kHeaviestGroup = 2;
+}
+
+// Constructor
+FecEncoder::FecEncoder(uint32_t protectedStream, uint32_t repairStream, uint8_t repairPayloadType)
+    : protectedSsrc(protectedStream),
+    fecSsrc(repairStream),
+    payloadType(repairPayloadType),
+    groupSize(0),
+    fecSeq(0) {
+    reset();
+}
+
+int FecEncoder::groupSizeForLoss(double lossFraction) {
+    for (const ProtectionStep& step : kSteps) {
+        if (lossFraction < step.loss) {
+            return step.groupSize;
+        }
+    }
+    return kHeaviestGroup;
+}
+
+void FecEncoder::setGroupSize(int packets) {
+    if (packets != groupSize) {
+        // Takes effect with the next group
+        groupSize = std::max(0, std::min(packets, 255));
+        reset();
+    }
+}
+
+void FecEncoder::reset() {
+    count = 0;
+    headerXor[0] = headerXor[1] = 0;
+    lengthXor = 0;
+    timestampXor = 0;
+    parityLength = 0;
+}
+
+// Parity
+size_t FecEncoder::protect(const uint8_t* header, const uint8_t* body, size_t bodyLength, uint8_t* out) {
+    if (groupSize == 0 || bodyLength > kMaxPacket - RtpPacketView::kFixedHeaderSize - kFecHeaderSize) {
+        return 0;
+    }
+
+    uint16_t seq = rtpReadU16(header + 2);
+    uint32_t timestamp = rtpReadU32(header + 4);
+
+    // Row FEC covers consecutive sequence numbers; a gap starts over
+    if (count > 0 && seq != nextSeq) {
+        reset();
+    }
+    if (count == 0) {
+        seqBase = seq;
+    }
+    nextSeq = static_cast<uint16_t>(seq + 1);
+    lastTimestamp = timestamp;
+
+    // Recovery fields: P, X, CC, M, PT, length and timestamp
+    headerXor[0] ^= header[0] & 0x3F;
+    headerXor[1] ^= header[1];
+    lengthXor ^= static_cast<uint16_t>(bodyLength);
+    timestampXor ^= timestamp;
+
+    // Shorter bodies count as zero-padded
+    if (bodyLength > parityLength) {
+        memset(parity + parityLength, 0, bodyLength - parityLength);
+        parityLength = bodyLength;
+    }
+    xorBytes(parity, body, bodyLength);
+
+    if (++count < groupSize) {
+        return 0;
+    }
+
+    // RTP header of the repair packet
+    out[0] = 0x80;
+    out[1] = payloadType & 0x7F;
+    rtpWriteU16(out + 2, fecSeq++);
+    rtpWriteU32(out + 4, lastTimestamp);
+    rtpWriteU32(out + 8, fecSsrc);
+
+    // FlexFEC header, R=0 F=1, one protected SSRC, L=groupSize D=1
+    uint8_t* fec = out + RtpPacketView::kFixedHeaderSize;
+    fec[0] = static_cast<uint8_t>(0x40 | headerXor[0]);
+    fec[1] = headerXor[1];
+    rtpWriteU16(fec + 2, lengthXor);
+    rtpWriteU32(fec + 4, timestampXor);
+    fec[8] = 1;
+    fec[9] = fec[10] = fec[11] = 0;
+    rtpWriteU32(fec + 12, protectedSsrc);
+    rtpWriteU16(fec + 16, seqBase);
+    fec[18] = static_cast<uint8_t>(groupSize);
+    fec[19] = 1;
+
+    memcpy(fec + kFecHeaderSize, parity, parityLength);
+    size_t length = RtpPacketView::kFixedHeaderSize + kFecHeaderSize + parityLength;
+    reset();
+    return length;
+}
+
+void FecEncoder::xorBytes(uint8_t* dst, const uint8_t* src, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(a, b));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < n; i++) {
+        dst[i] ^= src[i];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+// include/FecEncoder.h
+#ifndef FEC_ENCODER_H
+#define FEC_ENCODER_H
+
+#include <cstdint>
+#include <cstddef>
+
+// FlexFEC (RFC 8627) row parity for one outgoing RTP stream.
+//
+// Every groupSize consecutive media packets produce one repair packet
+// holding the XOR of their headers' recovery fields and of their bodies
+// (everything after the fixed 12-byte header), so any single loss in the
+// group is rebuilt by the receiver without a retransmission round trip.
+// The overhead is 1/groupSize of the stream; it is picked from the loss
+// the receiver reports in RTCP, and 0 turns protection off.
+class FecEncoder {
+public:
+    static const size_t kMaxPacket = 2048;
+    static const size_t kFecHeaderSize = 20;    // F=1: SSRCCount 1, L/D form
+
+    FecEncoder(uint32_t protectedSsrc, uint32_t fecSsrc, uint8_t payloadType);
+
+    // Protection for a smoothed RTCP loss fraction (0..1): 0 (off) or the
+    // number of media packets per repair packet
+    static int groupSizeForLoss(double lossFraction);
+
+    void setGroupSize(int packets);
+    int getGroupSize() const { return groupSize; }
+
+    // Feed a media packet as sent: its fixed header and the rest. When
+    // it completes a group, writes the repair packet to out (kMaxPacket
+    // bytes) and returns its length; otherwise returns 0.
+    size_t protect(const uint8_t* header, const uint8_t* body, size_t bodyLength, uint8_t* out);
+
+    // dst ^= src over n bytes
+    static void xorBytes(uint8_t* dst, const uint8_t* src, size_t n);
+
+private:
+    uint32_t protectedSsrc;
+    uint32_t fecSsrc;
+    uint8_t payloadType;
+    int groupSize;
+
+    // Group being accumulated
+    int count;
+    uint16_t seqBase;
+    uint16_t nextSeq;
+    uint8_t headerXor[2];
+    uint16_t lengthXor;
+    uint32_t timestampXor;
+    uint32_t lastTimestamp;
+    size_t parityLength;
+    uint8_t parity[kMaxPacket];
+
+    uint16_t fecSeq;
+
+    void reset();
+};
+
+#endif // FEC_ENCODER_H
\ No newline at end of file
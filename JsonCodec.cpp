@@ -0,0 +1,530 @@
+// src/JsonCodec.cpp
+#include "JsonCodec.h"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    // As cJSON's CJSON_NESTING_LIMIT
+    const int kMaxDepth = 1000;
+
+    // Integral doubles up to here print as integers; beyond 2^53 they
+    // are not exact anyway
+    const double kMaxExactInteger = 9007199254740992.0;
+
+    const char kHex[] = "0123456789abcdef";
+
+    // First quote or backslash in [p, end), plus control characters when
+    // kControls; end if there is none. Strings such as SDP are long runs
+    // with an escape every line, so this is where string time goes.
+    template <bool kControls>
+    const char* findSpecial(const char* p, const char* end) {
+#if defined(__AVX2__)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        for (; end - p >= 32; p += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash));
+            if (kControls) {
+                // Unsigned v <= 0x1F
+                hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+            }
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+        }
+#elif defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+            if (kControls) {
+                // Unsigned v <= 0x1F
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+            }
+            int mask = _mm_movemask_epi8(hit);
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t space = vdupq_n_u8(0x20);
+        for (; end - p >= 16; p += 16) {
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+            uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+            if (kControls) {
+                hit = vorrq_u8(hit, vcltq_u8(v, space));
+            }
+            // No movemask: narrow each lane to a nibble of a 64-bit mask
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+            if (mask) {
+                return p + (__builtin_ctzll(mask) >> 2);
+            }
+        }
+#endif
+        for (; p < end; p++) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\' || (kControls && c < 0x20)) {
+                return p;
+            }
+        }
+        return end;
+    }
+
+    // Printing
+    void printString(const char* value, std::string& out) {
+        out.push_back('"');
+        if (value) {
+            const char* p = value;
+            const char* end = value + strlen(value);
+            while (true) {
+                const char* special = findSpecial<true>(p, end);
+                out.append(p, special - p);
+                if (special == end) {
+                    break;
+                }
+                p = special + 1;
+
+                unsigned char c = static_cast<unsigned char>(*special);
+                switch (c) {
+                case '"': out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\b': out.append("\\b"); break;
+                case '\f': out.append("\\f"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default: {
+                    char escape[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F] };
+                    out.append(escape, sizeof(escape));
+                }
+                }
+            }
+        }
+        out.push_back('"');
+    }
+
+    void printValue(const cJSON* item, std::string& out, int depth, bool formatted) {
+        switch (item->type & 0xFF) {
+        case cJSON_NULL:
+            out.append("null");
+            break;
+        case cJSON_False:
+            out.append("false");
+            break;
+        case cJSON_True:
+            out.append("true");
+            break;
+        case cJSON_Number: {
+            char text[kJsonNumberMax];
+            out.append(text, jsonFormatNumber(item->valuedouble, text));
+            break;
+        }
+        case cJSON_String:
+            printString(item->valuestring, out);
+            break;
+        case cJSON_Raw:
+            if (!item->valuestring) {
+                throw std::runtime_error("Raw JSON item without text");
+            }
+            out.append(item->valuestring);
+            break;
+        case cJSON_Array:
+            out.push_back('[');
+            for (const cJSON* child = item->child; child; child = child->next) {
+                printValue(child, out, depth + 1, formatted);
+                if (child->next) {
+                    out.append(formatted ? ", " : ",");
+                }
+            }
+            out.push_back(']');
+            break;
+        case cJSON_Object:
+            // Layout of cJSON_Print: one member per line, tab-indented,
+            // tab after the colon, closing brace on its own line
+            out.push_back('{');
+            if (formatted) {
+                out.push_back('\n');
+            }
+            for (const cJSON* child = item->child; child; child = child->next) {
+                if (formatted) {
+                    out.append(depth + 1, '\t');
+                }
+                printString(child->string, out);
+                out.push_back(':');
+                if (formatted) {
+                    out.push_back('\t');
+                }
+                printValue(child, out, depth + 1, formatted);
+                if (child->next) {
+                    out.push_back(',');
+                }
+                if (formatted) {
+                    out.push_back('\n');
+                }
+            }
+            if (formatted) {
+                out.append(depth, '\t');
+            }
+            out.push_back('}');
+            break;
+        default:
+            throw std::runtime_error("Invalid JSON item");
+        }
+    }
+
+    // Parsing, destructive: strings are unescaped where they stand (the
+    // text never grows) and NUL-terminated over their closing quote, so
+    // cJSON copies them straight out of the input
+    class Parser {
+    public:
+        Parser(char* text, size_t length)
+            : start(text), p(text), end(text + length), depth(0) {
+        }
+
+        cJSON* parseDocument() {
+            skipWhitespace();
+            cJSON* root = parseValue();
+            if (root) {
+                skipWhitespace();
+                if (p != end) {
+                    cJSON_Delete(root);
+                    return nullptr;
+                }
+            }
+            return root;
+        }
+
+        size_t offset() const {
+            return static_cast<size_t>(p - start);
+        }
+
+    private:
+        char* start;
+        char* p;
+        char* end;
+        int depth;
+
+        void skipWhitespace() {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+                p++;
+            }
+        }
+
+        bool consume(const char* literal, size_t length) {
+            if (static_cast<size_t>(end - p) < length || memcmp(p, literal, length) != 0) {
+                return false;
+            }
+            p += length;
+            return true;
+        }
+
+        cJSON* parseValue() {
+            if (p == end) {
+                return nullptr;
+            }
+            switch (*p) {
+            case '{': return parseObject();
+            case '[': return parseArray();
+            case '"': {
+                const char* text = parseString();
+                return text ? cJSON_CreateString(text) : nullptr;
+            }
+            case 't': return consume("true", 4) ? cJSON_CreateTrue() : nullptr;
+            case 'f': return consume("false", 5) ? cJSON_CreateFalse() : nullptr;
+            case 'n': return consume("null", 4) ? cJSON_CreateNull() : nullptr;
+            default: return parseNumber();
+            }
+        }
+
+        cJSON* parseObject() {
+            if (++depth > kMaxDepth) {
+                return nullptr;
+            }
+            p++;
+            cJSON* object = cJSON_CreateObject();
+            skipWhitespace();
+            if (p < end && *p == '}') {
+                p++;
+                depth--;
+                return object;
+            }
+
+            while (true) {
+                skipWhitespace();
+                const char* key = p < end && *p == '"' ? parseString() : nullptr;
+                if (!key) {
+                    break;
+                }
+                skipWhitespace();
+                if (p == end || *p != ':') {
+                    break;
+                }
+                p++;
+                skipWhitespace();
+                cJSON* value = parseValue();
+                if (!value) {
+                    break;
+                }
+                cJSON_AddItemToObject(object, key, value);
+
+                skipWhitespace();
+                if (p < end && *p == ',') {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == '}') {
+                    p++;
+                    depth--;
+                    return object;
+                }
+                break;
+            }
+            cJSON_Delete(object);
+            return nullptr;
+        }
+
+        cJSON* parseArray() {
+            if (++depth > kMaxDepth) {
+                return nullptr;
+            }
+            p++;
+            cJSON* array = cJSON_CreateArray();
+            skipWhitespace();
+            if (p < end && *p == ']') {
+                p++;
+                depth--;
+                return array;
+            }
+
+            while (true) {
+                skipWhitespace();
+                cJSON* value = parseValue();
+                if (!value) {
+                    break;
+                }
+                cJSON_AddItemToArray(array, value);
+
+                skipWhitespace();
+                if (p < end && *p == ',') {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == ']') {
+                    p++;
+                    depth--;
+                    return array;
+                }
+                break;
+            }
+            cJSON_Delete(array);
+            return nullptr;
+        }
+
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        cJSON* parseNumber() {
+            const char* number = p;
+            if (p < end && *p == '-') {
+                p++;
+            }
+            if (p < end && *p == '0') {
+                p++;
+            }
+            else if (!skipDigits()) {
+                return nullptr;
+            }
+            if (p < end && *p == '.') {
+                p++;
+                if (!skipDigits()) {
+                    return nullptr;
+                }
+            }
+            if (p < end && (*p == 'e' || *p == 'E')) {
+                p++;
+                if (p < end && (*p == '+' || *p == '-')) {
+                    p++;
+                }
+                if (!skipDigits()) {
+                    return nullptr;
+                }
+            }
+
+            double value = 0.0;
+            std::from_chars_result result = std::from_chars(number, p, value);
+            if (result.ec == std::errc::result_out_of_range) {
+                // Overflow to infinity, underflow to zero, as strtod does
+                value = strtod(std::string(number, p - number).c_str(), nullptr);
+            }
+            else if (result.ec != std::errc() || result.ptr != p) {
+                return nullptr;
+            }
+            return cJSON_CreateNumber(value);
+        }
+
+        bool skipDigits() {
+            const char* digits = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                p++;
+            }
+            return p != digits;
+        }
+
+        int hexValue(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        bool parseHex4(uint32_t& codepoint) {
+            if (end - p < 4) {
+                return false;
+            }
+            codepoint = 0;
+            for (int i = 0; i < 4; i++) {
+                int digit = hexValue(p[i]);
+                if (digit < 0) {
+                    return false;
+                }
+                codepoint = (codepoint << 4) | static_cast<uint32_t>(digit);
+            }
+            p += 4;
+            return true;
+        }
+
+        // At most as long as the 6 or 12 byte escape it replaces
+        static char* writeUtf8(char* out, uint32_t codepoint) {
+            if (codepoint < 0x80) {
+                *out++ = static_cast<char>(codepoint);
+            }
+            else if (codepoint < 0x800) {
+                *out++ = static_cast<char>(0xC0 | (codepoint >> 6));
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else if (codepoint < 0x10000) {
+                *out++ = static_cast<char>(0xE0 | (codepoint >> 12));
+                *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else {
+                *out++ = static_cast<char>(0xF0 | (codepoint >> 18));
+                *out++ = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            return out;
+        }
+
+        // Unescapes the string at p (on its opening quote) in place and
+        // returns it, or nullptr if malformed. Runs between escapes are
+        // found by findSpecial and only moved once an escape has shrunk
+        // the text. Raw control characters are accepted, as cJSON does.
+        const char* parseString() {
+            char* text = ++p;
+            char* out = p;
+            while (true) {
+                char* special = p + (findSpecial<false>(p, end) - p);
+                if (out != p) {
+                    memmove(out, p, special - p);
+                }
+                out += special - p;
+                p = special;
+                if (p == end) {
+                    return nullptr;
+                }
+                if (*p++ == '"') {
+                    *out = '\0';
+                    return text;
+                }
+
+                if (p == end) {
+                    return nullptr;
+                }
+                switch (*p++) {
+                case '"': *out++ = '"'; break;
+                case '\\': *out++ = '\\'; break;
+                case '/': *out++ = '/'; break;
+                case 'b': *out++ = '\b'; break;
+                case 'f': *out++ = '\f'; break;
+                case 'n': *out++ = '\n'; break;
+                case 'r': *out++ = '\r'; break;
+                case 't': *out++ = '\t'; break;
+                case 'u': {
+                    uint32_t codepoint;
+                    if (!parseHex4(codepoint) || (codepoint >= 0xDC00 && codepoint <= 0xDFFF)) {
+                        return nullptr;
+                    }
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        // Surrogate pair
+                        uint32_t low;
+                        if (!consume("\\u", 2) || !parseHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return nullptr;
+                        }
+                        codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (low & 0x3FF));
+                    }
+                    out = writeUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    return nullptr;
+                }
+            }
+        }
+    };
+}
+
+size_t jsonFormatNumber(double value, char* out) {
+    if (!std::isfinite(value)) {
+        memcpy(out, "null", 4);
+        return 4;
+    }
+
+    std::to_chars_result result;
+    if (value == std::trunc(value) && std::fabs(value) < kMaxExactInteger) {
+        result = std::to_chars(out, out + kJsonNumberMax, static_cast<int64_t>(value));
+    }
+    else {
+        result = std::to_chars(out, out + kJsonNumberMax, value);
+    }
+    return static_cast<size_t>(result.ptr - out);
+}
+
+std::string jsonPrint(const cJSON* item, bool formatted) {
+    std::string out;
+    if (item) {
+        out.reserve(256);
+        printValue(item, out, 0, formatted);
+    }
+    return out;
+}
+
+cJSON* jsonParseInPlace(char* text, size_t length, size_t* errorOffset) {
+    Parser parser(text, length);
+    cJSON* root = parser.parseDocument();
+    if (!root && errorOffset) {
+        *errorOffset = parser.offset();
+    }
+    return root;
+}
+
+cJSON* jsonParse(const char* text, size_t length, size_t* errorOffset) {
+    std::string copy(text, length);
+    return jsonParseInPlace(&copy[0], length, errorOffset);
+}
\ No newline at end of file
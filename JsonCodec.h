@@ -0,0 +1,47 @@
+// include/JsonCodec.h
+#ifndef JSON_CODEC_H
+#define JSON_CODEC_H
+
+#include <string>
+#include <cstddef>
+#include <cjson/cJSON.h>
+
+// JSON text <-> cJSON trees for the signaling path.
+//
+// Drop-in for cJSON_Print/cJSON_PrintUnformatted and cJSON_Parse with the
+// same output layout and the same accepted input, but numbers go through
+// std::to_chars/std::from_chars (shortest round-trip, no locale) instead
+// of sprintf("%1.15g") with a re-parse check and strtod. Telemetry is
+// mostly non-integral doubles, where those dominated the cost. Strings
+// are scanned for quotes, backslashes and control characters 16 or 32
+// bytes at a time (SSE2, AVX2 or NEON), which is what large SDP payloads
+// spend their time on.
+//
+// Trees are still built and freed through cJSON, so its allocation hooks
+// and every existing accessor keep working.
+
+// Longest text jsonFormatNumber() writes
+const size_t kJsonNumberMax = 32;
+
+// Writes value as a JSON number and returns its length. Integral values
+// print without exponent like cJSON does; NaN and infinity print as null.
+size_t jsonFormatNumber(double value, char* out);
+
+// Serialize a tree; formatted matches cJSON_Print, otherwise compact
+std::string jsonPrint(const cJSON* item, bool formatted = true);
+
+// Parse one JSON value, optionally surrounded by whitespace. Returns
+// nullptr for malformed input with the offending offset in errorOffset.
+// Works on a copy of text.
+cJSON* jsonParse(const char* text, size_t length, size_t* errorOffset = nullptr);
+
+// As jsonParse, without the copy: strings are unescaped inside text,
+// whose contents are undefined afterwards. For receive buffers that are
+// discarded once parsed.
+cJSON* jsonParseInPlace(char* text, size_t length, size_t* errorOffset = nullptr);
+
+inline cJSON* jsonParse(const std::string& text, size_t* errorOffset = nullptr) {
+    return jsonParse(text.data(), text.size(), errorOffset);
+}
+
+#endif // JSON_CODEC_H
\ No newline at end of file
@@ -0,0 +1,417 @@
+// src/Logger.cpp
+#include "Logger.h"
+#include "Watchdog.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+namespace {
+    const uint32_t kRingCapacity = 256;     // Power of two; 64 KB per thread
+    const std::chrono::milliseconds kFlushInterval(50);
+
+    thread_local bool t_isFlusher = false;
+
+    uint64_t wallClockNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+// Single-producer/single-consumer ring owned by one logging thread
+struct Logger::Ring {
+    LogRecord records[kRingCapacity];
+    std::atomic<uint32_t> head;     // Next slot the producer writes
+    std::atomic<uint32_t> tail;     // Next slot the consumer reads
+    std::atomic<bool> orphaned;     // Owning thread has exited
+
+    Ring() : head(0), tail(0), orphaned(false) {}
+};
+
+// Thread-local handle; the flusher frees the ring once it is drained
+struct LoggerThreadState {
+    Logger::Ring* ring = nullptr;
+
+    ~LoggerThreadState() {
+        if (ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+    }
+};
+
+namespace {
+    thread_local LoggerThreadState t_loggerState;
+}
+
+// Level Conversion Functions
+const char* logLevelToString(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG: return "DEBUG";
+    case LogLevel::INFO: return "INFO";
+    case LogLevel::WARN: return "WARN";
+    case LogLevel::ERROR: return "ERROR";
+    default: return "UNKNOWN";
+    }
+}
+
+bool stringToLogLevel(const std::string& levelStr, LogLevel& level) {
+    if (levelStr == "DEBUG" || levelStr == "debug") { level = LogLevel::DEBUG; return true; }
+    if (levelStr == "INFO" || levelStr == "info") { level = LogLevel::INFO; return true; }
+    if (levelStr == "WARN" || levelStr == "warn") { level = LogLevel::WARN; return true; }
+    if (levelStr == "ERROR" || levelStr == "error") { level = LogLevel::ERROR; return true; }
+    return false;
+}
+
+// Constructor
+Logger& Logger::instance() {
+    // Intentionally leaked: threads may log during static destruction
+    static Logger* logger = new Logger();
+    return *logger;
+}
+
+Logger::Logger()
+    : minLevel(static_cast<uint8_t>(LogLevel::INFO)),
+    streamMinLevel(static_cast<uint8_t>(LogLevel::WARN)),
+    dropped(0),
+    output(stderr),
+    running(false),
+    flusherPolicy("rtc-log", 5),
+    flusherPolicyPending(true) {
+}
+
+// Flusher Management
+void Logger::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    flusherThread = std::thread(&Logger::runFlusher, this);
+}
+
+void Logger::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    wakeCondition.notify_one();
+    if (flusherThread.joinable()) {
+        flusherThread.join();
+    }
+
+    // Whatever was logged during shutdown
+    drain();
+}
+
+void Logger::runFlusher() {
+    t_isFlusher = true;
+    WatchdogLease watchdog("rtc-log");
+
+    while (running) {
+        watchdog.kick();
+
+        ThreadPolicy policy;
+        bool applyPolicy = false;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (flusherPolicyPending) {
+                policy = flusherPolicy;
+                applyPolicy = true;
+                flusherPolicyPending = false;
+            }
+            else {
+                wakeCondition.wait_for(lock, kFlushInterval);
+            }
+        }
+
+        if (applyPolicy) {
+            policy.apply();
+        }
+        drain();
+    }
+}
+
+void Logger::setThreadPolicy(const ThreadPolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        flusherPolicy = policy;
+        flusherPolicyPending = true;
+    }
+    wakeCondition.notify_one();
+}
+
+// Configuration
+bool Logger::setOutputFile(const std::string& path) {
+    FILE* file = stderr;
+    if (!path.empty()) {
+        file = fopen(path.c_str(), "a");
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(drainMutex);
+    if (output && output != stderr) {
+        fclose(output);
+    }
+    output = file;
+    return true;
+}
+
+void Logger::setLevel(LogLevel level) {
+    minLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() const {
+    return static_cast<LogLevel>(minLevel.load(std::memory_order_relaxed));
+}
+
+void Logger::setStream(StreamCallback callback, LogLevel streamLevel) {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    streamCallback = std::move(callback);
+    streamMinLevel.store(static_cast<uint8_t>(streamLevel), std::memory_order_relaxed);
+}
+
+void Logger::clearStream() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    streamCallback = nullptr;
+}
+
+uint64_t Logger::droppedRecords() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::logLines(LogLevel level, const std::string& text) {
+    if (!enabled(level)) {
+        return;
+    }
+
+    const size_t chunk = LogRecord::kStringPool - 1;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        for (size_t at = start; at < end; at += chunk) {
+            log(level, "  %s", text.substr(at, std::min(chunk, end - at)));
+        }
+        start = end + 1;
+    }
+}
+
+// Producer Side
+LogRecord* Logger::reserve() {
+    Ring* ring = t_loggerState.ring;
+    if (!ring) {
+        ring = new Ring();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.push_back(ring);
+        }
+        t_loggerState.ring = ring;
+    }
+
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= kRingCapacity) {
+        // Never block the caller; count what we lose instead
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    LogRecord* record = &ring->records[head & (kRingCapacity - 1)];
+    record->timestampNs = wallClockNs();
+    record->streamable = !t_isFlusher;
+    return record;
+}
+
+void Logger::commit() {
+    Ring* ring = t_loggerState.ring;
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    LogLevel level = ring->records[head & (kRingCapacity - 1)].level;
+    ring->head.store(head + 1, std::memory_order_release);
+
+    if (!running) {
+        // No flusher yet (or any more): write synchronously
+        drain();
+    }
+    else if (level >= LogLevel::ERROR) {
+        wakeCondition.notify_one();
+    }
+}
+
+// Consumer Side
+void Logger::drain() {
+    std::vector<std::string> streamed;
+    StreamCallback callback;
+
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+
+        std::vector<Ring*> snapshot;
+        {
+            std::lock_guard<std::mutex> ringsLock(ringsMutex);
+            snapshot = rings;
+        }
+
+        LogLevel streamLevel = static_cast<LogLevel>(streamMinLevel.load(std::memory_order_relaxed));
+
+        for (Ring* ring : snapshot) {
+            // Orphaned is read first so no record committed before the
+            // owner exited can be missed below
+            bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+
+            uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint32_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; tail++) {
+                const LogRecord& record = ring->records[tail & (kRingCapacity - 1)];
+                std::string line = format(record);
+                fputs(line.c_str(), output);
+
+                if (streamCallback && record.streamable && record.level >= streamLevel) {
+                    line.pop_back();    // Drop the newline
+                    streamed.push_back(std::move(line));
+                }
+            }
+            ring->tail.store(tail, std::memory_order_release);
+
+            if (orphaned) {
+                std::lock_guard<std::mutex> ringsLock(ringsMutex);
+                for (size_t i = 0; i < rings.size(); i++) {
+                    if (rings[i] == ring) {
+                        rings.erase(rings.begin() + i);
+                        break;
+                    }
+                }
+                delete ring;
+            }
+        }
+
+        fflush(output);
+        callback = streamCallback;
+    }
+
+    // Outside the lock: the callback may itself log
+    if (callback && !streamed.empty()) {
+        callback(std::move(streamed));
+    }
+}
+
+std::string Logger::format(const LogRecord& record) {
+    // Timestamp prefix: UTC wall clock with milliseconds
+    time_t seconds = static_cast<time_t>(record.timestampNs / 1000000000ULL);
+    unsigned int millis = static_cast<unsigned int>((record.timestampNs / 1000000ULL) % 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+
+    char prefix[48];
+    size_t prefixLen = strftime(prefix, sizeof(prefix), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(prefix + prefixLen, sizeof(prefix) - prefixLen, ".%03uZ %c ",
+        millis, logLevelToString(record.level)[0]);
+
+    std::string line(prefix);
+
+    // Expand the printf-style format one conversion at a time
+    size_t argIndex = 0;
+    const char* p = record.format;
+    while (*p) {
+        if (*p != '%') {
+            line.push_back(*p++);
+            continue;
+        }
+
+        if (p[1] == '%') {
+            line.push_back('%');
+            p += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept; length modifiers are
+        // replaced to match the stored 64-bit argument
+        std::string spec("%");
+        const char* q = p + 1;
+        while (*q && strchr("-+ #0123456789.", *q)) {
+            spec.push_back(*q++);
+        }
+        while (*q && strchr("hlLqjzt", *q)) {
+            q++;
+        }
+
+        char conversion = *q;
+        if (!conversion) {
+            break;
+        }
+        p = q + 1;
+
+        if (argIndex >= record.argCount) {
+            line.append("(missing)");
+            continue;
+        }
+
+        LogRecord::ArgType type = record.types[argIndex];
+        const auto& arg = record.args[argIndex];
+        argIndex++;
+
+        char buffer[256];
+        buffer[0] = '\0';
+
+        switch (conversion) {
+        case 'd':
+        case 'i':
+            spec.append("ll").push_back(conversion);
+            snprintf(buffer, sizeof(buffer), spec.c_str(),
+                type == LogRecord::DOUBLE ? static_cast<long long>(arg.d) : static_cast<long long>(arg.i));
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec.append("ll").push_back(conversion);
+            snprintf(buffer, sizeof(buffer), spec.c_str(),
+                type == LogRecord::DOUBLE ? static_cast<unsigned long long>(arg.d) : static_cast<unsigned long long>(arg.u));
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': {
+            double value = type == LogRecord::DOUBLE ? arg.d :
+                type == LogRecord::UINT ? static_cast<double>(arg.u) : static_cast<double>(arg.i);
+            spec.push_back(conversion);
+            snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+            break;
+        }
+
+        case 'c':
+            spec.push_back('c');
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(arg.i));
+            break;
+
+        case 'p':
+            snprintf(buffer, sizeof(buffer), "%p", arg.p);
+            break;
+
+        case 's':
+            if (type == LogRecord::STRING) {
+                spec.push_back('s');
+                snprintf(buffer, sizeof(buffer), spec.c_str(), record.pool + arg.stringOffset);
+            }
+            else {
+                snprintf(buffer, sizeof(buffer), "(?)");
+            }
+            break;
+
+        default:
+            snprintf(buffer, sizeof(buffer), "(?)");
+            break;
+        }
+
+        line.append(buffer);
+    }
+
+    line.push_back('\n');
+    return line;
+}
\ No newline at end of file
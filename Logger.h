@@ -0,0 +1,228 @@
+// include/Logger.h
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include "ThreadPolicy.h"
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+};
+
+const char* logLevelToString(LogLevel level);
+bool stringToLogLevel(const std::string& levelStr, LogLevel& level);
+
+// Binary log record; the format string is a literal and is only expanded
+// by the flusher thread, so the logging thread never formats or blocks
+struct LogRecord {
+    static const size_t kMaxArgs = 8;
+    static const size_t kStringPool = 144;
+
+    enum ArgType : uint8_t { INT, UINT, DOUBLE, STRING, POINTER };
+
+    uint64_t timestampNs;
+    const char* format;
+    LogLevel level;
+    bool streamable;        // False for records logged by the flusher itself
+    uint8_t argCount;
+    uint8_t poolUsed;
+    ArgType types[kMaxArgs];
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        uint16_t stringOffset;
+        const void* p;
+    } args[kMaxArgs];
+    char pool[kStringPool];
+};
+
+// Process-wide logger.
+//
+// Each thread owns a single-producer ring of LogRecords; a background
+// flusher drains all rings, formats, writes to stderr or a file and
+// optionally hands batches to a stream callback (used for LOG messages).
+// Levels can be changed at runtime, e.g. from a remote request.
+class Logger {
+public:
+    typedef std::function<void(std::vector<std::string>&& lines)> StreamCallback;
+
+    static Logger& instance();
+
+    void start();
+    void stop();
+
+    // Picked up by the flusher on its next wake
+    void setThreadPolicy(const ThreadPolicy& policy);
+
+    // Output selection; an empty path means stderr
+    bool setOutputFile(const std::string& path);
+
+    // Filters
+    void setLevel(LogLevel level);
+    LogLevel getLevel() const;
+    bool enabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    // Forward formatted lines at or above streamLevel to callback
+    void setStream(StreamCallback callback, LogLevel streamLevel);
+    void clearStream();
+
+    uint64_t droppedRecords() const;
+
+    // Multi-line text too long for one record's string pool (hang
+    // reports, backtraces): one record per line, long lines split
+    void logLines(LogLevel level, const std::string& text);
+
+    template <typename... Args>
+    void log(LogLevel level, const char* format, const Args&... args) {
+        LogRecord* record = reserve();
+        if (!record) {
+            return;
+        }
+        record->level = level;
+        record->format = format;
+        record->argCount = 0;
+        record->poolUsed = 0;
+        encode(*record, args...);
+        commit();
+    }
+
+private:
+    Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Ring;
+    friend struct LoggerThreadState;
+
+    std::atomic<uint8_t> minLevel;
+    std::atomic<uint8_t> streamMinLevel;
+    std::atomic<uint64_t> dropped;
+
+    std::mutex ringsMutex;
+    std::vector<Ring*> rings;
+
+    // Single consumer: the flusher, or the caller while it is stopped
+    std::mutex drainMutex;
+    FILE* output;
+    StreamCallback streamCallback;
+
+    std::atomic<bool> running;
+    std::thread flusherThread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    ThreadPolicy flusherPolicy;
+    bool flusherPolicyPending;
+
+    LogRecord* reserve();
+    void commit();
+    void runFlusher();
+    void drain();
+    static std::string format(const LogRecord& record);
+
+    // Argument encoding
+    static void encode(LogRecord&) {}
+
+    template <typename T, typename... Rest>
+    static void encode(LogRecord& record, const T& value, const Rest&... rest) {
+        if (record.argCount < LogRecord::kMaxArgs) {
+            encodeArg(record, value);
+        }
+        encode(record, rest...);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+        encodeArg(LogRecord& record, T value) {
+        record.types[record.argCount] = LogRecord::INT;
+        record.args[record.argCount++].i = value;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+        encodeArg(LogRecord& record, T value) {
+        record.types[record.argCount] = LogRecord::UINT;
+        record.args[record.argCount++].u = value;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type
+        encodeArg(LogRecord& record, T value) {
+        encodeArg(record, static_cast<typename std::underlying_type<T>::type>(value));
+    }
+
+    static void encodeArg(LogRecord& record, double value) {
+        record.types[record.argCount] = LogRecord::DOUBLE;
+        record.args[record.argCount++].d = value;
+    }
+
+    static void encodeArg(LogRecord& record, float value) {
+        encodeArg(record, static_cast<double>(value));
+    }
+
+    static void encodeArg(LogRecord& record, const void* value) {
+        record.types[record.argCount] = LogRecord::POINTER;
+        record.args[record.argCount++].p = value;
+    }
+
+    // Strings are copied into the record (truncated to fit the pool)
+    static void encodeArg(LogRecord& record, const char* value) {
+        size_t room = LogRecord::kStringPool - record.poolUsed;
+        size_t len = value ? strlen(value) : 0;
+        if (room == 0) {
+            len = 0;
+        }
+        else if (len >= room) {
+            len = room - 1;
+        }
+
+        char* dest = record.pool + record.poolUsed;
+        if (room > 0) {
+            memcpy(dest, value ? value : "", len);
+            dest[len] = '\0';
+        }
+
+        record.types[record.argCount] = LogRecord::STRING;
+        record.args[record.argCount++].stringOffset = record.poolUsed;
+        record.poolUsed = static_cast<uint8_t>(record.poolUsed + (room > 0 ? len + 1 : 0));
+    }
+
+    static void encodeArg(LogRecord& record, char* value) {
+        encodeArg(record, static_cast<const char*>(value));
+    }
+
+    static void encodeArg(LogRecord& record, const std::string& value) {
+        encodeArg(record, value.c_str());
+    }
+};
+
+// The format must be a string literal: it is read later by the flusher
+#define LOG_AT(level, fmt, ...) \
+    do { \
+        if (Logger::instance().enabled(level)) { \
+            Logger::instance().log(level, "" fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(fmt, ...) LOG_AT(LogLevel::DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...) LOG_AT(LogLevel::INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...) LOG_AT(LogLevel::WARN, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(LogLevel::ERROR, fmt, ##__VA_ARGS__)
+
+#endif // LOGGER_H
\ No newline at end of file
@@ -0,0 +1,193 @@
+// src/MemoryAccounting.cpp
+#include "MemoryAccounting.h"
+#include <libwebsockets.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    // Keeps the user pointer 16-byte aligned, like malloc on 64-bit targets
+    struct alignas(16) AllocationHeader {
+        size_t size;
+        MemoryTag tag;
+    };
+
+    AllocationHeader* headerOf(void* ptr) {
+        return reinterpret_cast<AllocationHeader*>(ptr) - 1;
+    }
+
+    // cJSON hooks; with custom hooks installed cJSON never calls realloc
+    void* jsonMalloc(size_t size) {
+        return MemoryAccounting::allocate(MemoryTag::JSON, size);
+    }
+
+    void jsonFree(void* ptr) {
+        MemoryAccounting::deallocate(ptr);
+    }
+
+    // libwebsockets uses a single realloc-style hook; size 0 means free
+    void* lwsRealloc(void* ptr, size_t size, const char* reason) {
+        (void)reason;
+        if (size == 0) {
+            MemoryAccounting::deallocate(ptr);
+            return nullptr;
+        }
+        return MemoryAccounting::reallocate(MemoryTag::WEBSOCKET, ptr, size);
+    }
+
+    // Process-wide figures from /proc, in kB; 0 when unavailable
+    void readProcessMemory(long& rssKb, long& hwmKb) {
+        rssKb = 0;
+        hwmKb = 0;
+
+        FILE* file = fopen("/proc/self/status", "r");
+        if (!file) {
+            return;
+        }
+
+        char line[128];
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "VmRSS:", 6) == 0) {
+                rssKb = strtol(line + 6, nullptr, 10);
+            }
+            else if (strncmp(line, "VmHWM:", 6) == 0) {
+                hwmKb = strtol(line + 6, nullptr, 10);
+            }
+        }
+        fclose(file);
+    }
+}
+
+MemoryAccounting::Counters MemoryAccounting::counters[static_cast<size_t>(MemoryTag::COUNT)];
+
+const char* memoryTagToString(MemoryTag tag) {
+    switch (tag) {
+    case MemoryTag::JSON: return "json";
+    case MemoryTag::WEBSOCKET: return "websocket";
+    case MemoryTag::QUEUES: return "queues";
+    case MemoryTag::PACKETS: return "packets";
+    default: return "unknown";
+    }
+}
+
+void MemoryAccounting::install() {
+    cJSON_Hooks hooks;
+    hooks.malloc_fn = jsonMalloc;
+    hooks.free_fn = jsonFree;
+    cJSON_InitHooks(&hooks);
+
+    lws_set_allocator(lwsRealloc);
+}
+
+// Tagged Heap
+void* MemoryAccounting::allocate(MemoryTag tag, size_t size) {
+    void* memory = malloc(sizeof(AllocationHeader) + size);
+    if (!memory) {
+        return nullptr;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(memory);
+    header->size = size;
+    header->tag = tag;
+    charge(tag, size);
+    return header + 1;
+}
+
+void* MemoryAccounting::reallocate(MemoryTag tag, void* ptr, size_t size) {
+    if (!ptr) {
+        return allocate(tag, size);
+    }
+
+    AllocationHeader* header = headerOf(ptr);
+    size_t oldSize = header->size;
+    MemoryTag oldTag = header->tag;
+
+    void* memory = realloc(header, sizeof(AllocationHeader) + size);
+    if (!memory) {
+        return nullptr;
+    }
+
+    // The block keeps the tag it was first charged to
+    header = static_cast<AllocationHeader*>(memory);
+    header->size = size;
+    release(oldTag, oldSize);
+    charge(oldTag, size);
+    return header + 1;
+}
+
+void MemoryAccounting::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    AllocationHeader* header = headerOf(ptr);
+    release(header->tag, header->size);
+    free(header);
+}
+
+void MemoryAccounting::charge(MemoryTag tag, size_t bytes) {
+    Counters& counter = counters[static_cast<size_t>(tag)];
+    size_t now = counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    size_t high = counter.peak.load(std::memory_order_relaxed);
+    while (now > high &&
+        !counter.peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryAccounting::release(MemoryTag tag, size_t bytes) {
+    counters[static_cast<size_t>(tag)].current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// Budgets
+void MemoryAccounting::setBudget(MemoryTag tag, size_t bytes) {
+    counters[static_cast<size_t>(tag)].budget.store(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryAccounting::getBudget(MemoryTag tag) {
+    return counters[static_cast<size_t>(tag)].budget.load(std::memory_order_relaxed);
+}
+
+bool MemoryAccounting::withinBudget(MemoryTag tag, size_t extra) {
+    const Counters& counter = counters[static_cast<size_t>(tag)];
+    size_t limit = counter.budget.load(std::memory_order_relaxed);
+    return limit == 0 || counter.current.load(std::memory_order_relaxed) + extra <= limit;
+}
+
+bool MemoryAccounting::underPressure() {
+    for (size_t i = 0; i < static_cast<size_t>(MemoryTag::COUNT); i++) {
+        if (!withinBudget(static_cast<MemoryTag>(i))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Usage
+size_t MemoryAccounting::current(MemoryTag tag) {
+    return counters[static_cast<size_t>(tag)].current.load(std::memory_order_relaxed);
+}
+
+size_t MemoryAccounting::peak(MemoryTag tag) {
+    return counters[static_cast<size_t>(tag)].peak.load(std::memory_order_relaxed);
+}
+
+cJSON* MemoryAccounting::toJson() {
+    cJSON* report = cJSON_CreateObject();
+
+    for (size_t i = 0; i < static_cast<size_t>(MemoryTag::COUNT); i++) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        cJSON* usage = cJSON_AddObjectToObject(report, memoryTagToString(tag));
+        cJSON_AddNumberToObject(usage, "current", static_cast<double>(current(tag)));
+        cJSON_AddNumberToObject(usage, "peak", static_cast<double>(peak(tag)));
+        cJSON_AddNumberToObject(usage, "budget", static_cast<double>(getBudget(tag)));
+    }
+
+    long rssKb, hwmKb;
+    readProcessMemory(rssKb, hwmKb);
+    cJSON_AddNumberToObject(report, "rss_kb", static_cast<double>(rssKb));
+    cJSON_AddNumberToObject(report, "hwm_kb", static_cast<double>(hwmKb));
+    cJSON_AddBoolToObject(report, "pressure", underPressure());
+
+    return report;
+}
\ No newline at end of file
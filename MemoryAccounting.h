@@ -0,0 +1,116 @@
+// include/MemoryAccounting.h
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <string>
+#include <limits>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+// Subsystems whose heap usage is tracked separately
+enum class MemoryTag : uint8_t {
+    JSON,           // cJSON trees and printed documents
+    WEBSOCKET,      // libwebsockets internal buffers
+    QUEUES,         // Outbound signaling frames
+    PACKETS,        // Media packet pools
+    COUNT
+};
+
+const char* memoryTagToString(MemoryTag tag);
+
+// Per-subsystem heap accounting.
+//
+// Tagged allocations carry a 16-byte header holding their size and tag,
+// so a free is charged back to the right subsystem without a lookup.
+// Budgets are not enforced inside the allocator: a library that sees a
+// failed malloc halfway through a parse rarely recovers cleanly. Instead
+// callers check withinBudget() where work can be shed safely (queueing a
+// frame, starting optional diagnostics) and degrade from there.
+class MemoryAccounting {
+public:
+    // Route cJSON and libwebsockets through the tagged allocator. Call
+    // once at startup, before either library allocates anything.
+    static void install();
+
+    // Tagged heap
+    static void* allocate(MemoryTag tag, size_t size);
+    static void* reallocate(MemoryTag tag, void* ptr, size_t size);
+    static void deallocate(void* ptr);
+
+    // Budgets in bytes; 0 means unlimited
+    static void setBudget(MemoryTag tag, size_t bytes);
+    static size_t getBudget(MemoryTag tag);
+    static bool withinBudget(MemoryTag tag, size_t extra = 0);
+    static bool underPressure();
+
+    // Usage
+    static size_t current(MemoryTag tag);
+    static size_t peak(MemoryTag tag);
+
+    // {"json": {"current": n, "peak": n, "budget": n}, ..., "rss_kb": n, "hwm_kb": n}
+    static cJSON* toJson();
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<size_t> current;
+        std::atomic<size_t> peak;
+        std::atomic<size_t> budget;
+    };
+
+    // Zero-initialised before any dynamic initialisation runs
+    static Counters counters[static_cast<size_t>(MemoryTag::COUNT)];
+
+    static void charge(MemoryTag tag, size_t bytes);
+    static void release(MemoryTag tag, size_t bytes);
+};
+
+// Standard allocator that charges a fixed subsystem, for containers
+template <typename T, MemoryTag Tag>
+class TaggedAllocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef TaggedAllocator<U, Tag> other;
+    };
+
+    TaggedAllocator() noexcept {}
+
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* memory = MemoryAccounting::allocate(Tag, n * sizeof(T));
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        MemoryAccounting::deallocate(ptr);
+    }
+};
+
+template <typename T, typename U, MemoryTag Tag>
+bool operator==(const TaggedAllocator<T, Tag>&, const TaggedAllocator<U, Tag>&) {
+    return true;
+}
+
+template <typename T, typename U, MemoryTag Tag>
+bool operator!=(const TaggedAllocator<T, Tag>&, const TaggedAllocator<U, Tag>&) {
+    return false;
+}
+
+// Outbound websocket frame (LWS_PRE headroom plus payload) charged to QUEUES
+typedef std::basic_string<char, std::char_traits<char>,
+    TaggedAllocator<char, MemoryTag::QUEUES>> QueuedFrame;
+
+#endif // MEMORY_ACCOUNTING_H
\ No newline at end of file
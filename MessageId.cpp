@@ -0,0 +1,173 @@
+// src/MessageId.cpp
+#include "MessageId.h"
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+    const char kBase32Alphabet[] = "0123456789abcdefghjkmnpqrstvwxyz";
+
+    int base32Value(char c) {
+        const char* pos = strchr(kBase32Alphabet, c);
+        return (c != '\0' && pos) ? static_cast<int>(pos - kBase32Alphabet) : -1;
+    }
+
+    uint64_t mix64(uint64_t value) {
+        // splitmix64 finalizer
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+}
+
+// Message ID
+MessageId::MessageId()
+    : length(0) {
+    text[0] = '\0';
+}
+
+bool MessageId::parse(const std::string& id, uint32_t& prefix, uint64_t& counter) {
+    if (id.size() <= kPrefixLength || id.size() > kMaxLength) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < id.size(); i++) {
+        int digit = base32Value(id[i]);
+        if (digit < 0) {
+            return false;
+        }
+
+        if (i == kPrefixLength) {
+            prefix = static_cast<uint32_t>(value);
+            value = 0;
+        }
+        value = (value << 5) | static_cast<uint64_t>(digit);
+    }
+
+    counter = value;
+    return true;
+}
+
+// Message ID Generator
+MessageIdGenerator::MessageIdGenerator(const std::string& nodeName)
+    : counter(1) {
+
+    uint64_t seed = 14695981039346656037ULL;
+    for (char c : nodeName) {
+        seed = (seed ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+
+    // Boot nonce: wall clock plus pid distinguishes restarts
+    uint64_t nonce = static_cast<uint64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count());
+    nonce ^= static_cast<uint64_t>(getpid()) << 40;
+
+    prefix = static_cast<uint32_t>(mix64(seed ^ mix64(nonce)) & ((1u << (5 * MessageId::kPrefixLength)) - 1));
+}
+
+MessageId MessageIdGenerator::next() {
+    uint64_t value = counter.fetch_add(1, std::memory_order_relaxed);
+
+    MessageId id;
+
+    // Fixed-width prefix
+    for (size_t i = 0; i < MessageId::kPrefixLength; i++) {
+        id.text[i] = kBase32Alphabet[(prefix >> (5 * (MessageId::kPrefixLength - 1 - i))) & 31];
+    }
+
+    // Variable-width counter, most significant digit first
+    char digits[MessageId::kMaxLength - MessageId::kPrefixLength];
+    size_t count = 0;
+    do {
+        digits[count++] = kBase32Alphabet[value & 31];
+        value >>= 5;
+    } while (value != 0 && count < sizeof(digits));
+
+    size_t pos = MessageId::kPrefixLength;
+    while (count > 0) {
+        id.text[pos++] = digits[--count];
+    }
+
+    id.text[pos] = '\0';
+    id.length = static_cast<uint8_t>(pos);
+    return id;
+}
+
+uint32_t MessageIdGenerator::getPrefix() const {
+    return prefix;
+}
+
+// Duplicate Filter
+DuplicateFilter::DuplicateFilter()
+    : currentPrefix(0), highest(0) {
+    memset(window, 0, sizeof(window));
+}
+
+void DuplicateFilter::shift(uint64_t distance) {
+    const size_t words = kWindow / 64;
+
+    if (distance >= kWindow) {
+        memset(window, 0, sizeof(window));
+        return;
+    }
+
+    // Move every bit "distance" positions further from highest
+    size_t wordShift = static_cast<size_t>(distance / 64);
+    unsigned int bitShift = static_cast<unsigned int>(distance % 64);
+
+    for (size_t i = words; i-- > 0;) {
+        uint64_t value = 0;
+        if (i >= wordShift) {
+            value = window[i - wordShift] << bitShift;
+            if (bitShift && i > wordShift) {
+                value |= window[i - wordShift - 1] >> (64 - bitShift);
+            }
+        }
+        window[i] = value;
+    }
+}
+
+bool DuplicateFilter::accept(uint32_t prefix, uint64_t counter) {
+    // A new sender process starts a fresh sequence
+    if (prefix != currentPrefix || highest == 0) {
+        currentPrefix = prefix;
+        highest = counter;
+        memset(window, 0, sizeof(window));
+        window[0] = 1;
+        return true;
+    }
+
+    if (counter > highest) {
+        shift(counter - highest);
+        highest = counter;
+        window[0] |= 1;
+        return true;
+    }
+
+    uint64_t age = highest - counter;
+    if (age >= kWindow) {
+        return false;
+    }
+
+    uint64_t mask = 1ULL << (age % 64);
+    uint64_t& word = window[age / 64];
+    if (word & mask) {
+        return false;
+    }
+
+    word |= mask;
+    return true;
+}
+
+bool DuplicateFilter::accept(const std::string& id) {
+    uint32_t prefix;
+    uint64_t counter;
+    if (!MessageId::parse(id, prefix, counter)) {
+        return true;
+    }
+    return accept(prefix, counter);
+}
\ No newline at end of file
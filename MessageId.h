@@ -0,0 +1,75 @@
+// include/MessageId.h
+#ifndef MESSAGE_ID_H
+#define MESSAGE_ID_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Message id of the form <prefix><counter>, both base32 (Crockford,
+// lowercase). The prefix is 4 characters identifying the sending process;
+// the counter is 1-11 characters. At most 15 characters, so converting to
+// std::string stays within the small-string buffer and never allocates.
+class MessageId {
+public:
+    static const size_t kPrefixLength = 4;
+    static const size_t kMaxLength = 15;
+
+    MessageId();
+
+    const char* c_str() const { return text; }
+    size_t size() const { return length; }
+    std::string str() const { return std::string(text, length); }
+
+    // Split a received id back into its parts; false for foreign ids
+    static bool parse(const std::string& id, uint32_t& prefix, uint64_t& counter);
+
+private:
+    friend class MessageIdGenerator;
+
+    char text[kMaxLength + 1];
+    uint8_t length;
+};
+
+// Per-process generator; thread-safe, one atomic increment per id
+class MessageIdGenerator {
+public:
+    // The node name (e.g. device id) is mixed with a per-boot nonce so a
+    // restarted process never reuses the ids of its previous run
+    explicit MessageIdGenerator(const std::string& nodeName);
+
+    MessageId next();
+
+    uint32_t getPrefix() const;
+
+private:
+    uint32_t prefix;
+    std::atomic<uint64_t> counter;
+};
+
+// Receive-side duplicate detection over a sliding window of counters.
+// Retransmissions arrive close to the original, so a 128-entry bitmap
+// behind the highest counter seen is enough; anything older is treated
+// as a duplicate.
+class DuplicateFilter {
+public:
+    DuplicateFilter();
+
+    // True the first time a (prefix, counter) pair is seen
+    bool accept(uint32_t prefix, uint64_t counter);
+
+    // Convenience for raw ids; foreign ids are always accepted
+    bool accept(const std::string& id);
+
+private:
+    static const uint64_t kWindow = 128;
+
+    uint32_t currentPrefix;
+    uint64_t highest;
+    uint64_t window[kWindow / 64];    // Bit i: highest - i was seen
+
+    void shift(uint64_t distance);
+};
+
+#endif // MESSAGE_ID_H
\ No newline at end of file
@@ -0,0 +1,196 @@
+// src/MessageTemplate.cpp
+#include "MessageTemplate.h"
+#include "JsonCodec.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Placeholders are strings starting with a control character, which
+    // cJSON prints as \u0001; nothing else in a skeleton contains one
+    const char kMarker = '\x01';
+    const char kPrintedMarker[] = "\"\\u0001";
+    const char kIdName[] = "id";
+
+    const char kNull[] = "null";
+
+    void appendEscaped(std::string& out, const char* value, size_t length) {
+        static const char kHex[] = "0123456789abcdef";
+
+        out.push_back('"');
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(value[i]);
+            switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    char escape[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F] };
+                    out.append(escape, sizeof(escape));
+                }
+                else {
+                    out.push_back(static_cast<char>(c));
+                }
+            }
+        }
+        out.push_back('"');
+    }
+}
+
+// PreparedMessage
+PreparedMessage::PreparedMessage()
+    : type(SignalingMessageType::HEARTBEAT),
+    metadataEmpty(true) {
+}
+
+void PreparedMessage::addMetadata(const std::string& key, const std::string& value) {
+    // Insert before the closing braces of metadata and of the message
+    std::string entry;
+    entry.reserve(key.size() + value.size() + 8);
+    if (!metadataEmpty) {
+        entry.push_back(',');
+    }
+    appendEscaped(entry, key.data(), key.size());
+    entry.push_back(':');
+    appendEscaped(entry, value.data(), value.size());
+
+    frame.insert(frame.size() - 2, entry);
+    metadataEmpty = false;
+}
+
+// MessageTemplate
+MessageTemplate::MessageTemplate(SignalingMessageType messageType)
+    : type(messageType),
+    metadataEmpty(true) {
+}
+
+cJSON* MessageTemplate::slot(size_t index) {
+    std::string marker(1, kMarker);
+    marker += std::to_string(index);
+    return cJSON_CreateString(marker.c_str());
+}
+
+void MessageTemplate::compile(const cJSON* payload, const std::map<std::string, std::string>& metadata) {
+    // Same fields and order as SignalingMessage::serialize(); metadata is
+    // always present and last so it can be extended in place
+    cJSON* root = cJSON_CreateObject();
+    if (!root) {
+        throw std::runtime_error("Failed to create JSON object");
+    }
+    cJSON_AddStringToObject(root, "type", signalingMessageTypeToString(type).c_str());
+    cJSON_AddStringToObject(root, "id", (std::string(1, kMarker) + kIdName).c_str());
+    if (payload) {
+        cJSON_AddItemToObject(root, "payload", cJSON_Duplicate(payload, 1));
+    }
+    cJSON* metadataJson = cJSON_AddObjectToObject(root, "metadata");
+    for (const auto& pair : metadata) {
+        cJSON_AddStringToObject(metadataJson, pair.first.c_str(), pair.second.c_str());
+    }
+
+    char* printed = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!printed) {
+        throw std::runtime_error("Failed to convert JSON to string");
+    }
+    std::string skeleton(printed);
+    cJSON_free(printed);
+
+    // Cut at each placeholder, quotes included
+    literals.clear();
+    gaps.clear();
+    size_t slotCount = 0;
+    size_t from = 0;
+    size_t at;
+    while ((at = skeleton.find(kPrintedMarker, from)) != std::string::npos) {
+        size_t nameStart = at + sizeof(kPrintedMarker) - 1;
+        size_t end = skeleton.find('"', nameStart);
+        if (end == std::string::npos) {
+            throw std::runtime_error("Malformed message template");
+        }
+
+        std::string name = skeleton.substr(nameStart, end - nameStart);
+        int gap = kIdGap;
+        if (name != kIdName) {
+            gap = atoi(name.c_str());
+            slotCount = std::max(slotCount, static_cast<size_t>(gap) + 1);
+        }
+
+        literals.push_back(skeleton.substr(from, at - from));
+        gaps.push_back(gap);
+        from = end + 1;
+    }
+    literals.push_back(skeleton.substr(from));
+
+    values.assign(slotCount, kNull);
+    metadataEmpty = metadata.empty();
+}
+
+void MessageTemplate::setInt(size_t index, int64_t value) {
+    char text[24];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+    values.at(index).assign(text, result.ptr);
+}
+
+void MessageTemplate::setDouble(size_t index, double value) {
+    char text[kJsonNumberMax];
+    values.at(index).assign(text, jsonFormatNumber(value, text));
+}
+
+void MessageTemplate::setBool(size_t index, bool value) {
+    values.at(index).assign(value ? "true" : "false");
+}
+
+void MessageTemplate::setString(size_t index, const std::string& value) {
+    std::string& slotValue = values.at(index);
+    slotValue.clear();
+    appendEscaped(slotValue, value.data(), value.size());
+}
+
+void MessageTemplate::setJson(size_t index, cJSON* json) {
+    if (!json) {
+        values.at(index).assign(kNull);
+        return;
+    }
+    try {
+        values.at(index) = jsonPrint(json, false);
+    }
+    catch (...) {
+        cJSON_Delete(json);
+        throw;
+    }
+    cJSON_Delete(json);
+}
+
+void MessageTemplate::render(const MessageId& id, PreparedMessage& out) const {
+    size_t total = 0;
+    for (const std::string& literal : literals) {
+        total += literal.size();
+    }
+    for (int gap : gaps) {
+        total += gap == kIdGap ? id.size() + 2 : values[gap].size();
+    }
+
+    out.type = type;
+    out.metadataEmpty = metadataEmpty;
+    out.frame.clear();
+    out.frame.reserve(total + 64);          // Room for seq and ack
+
+    for (size_t i = 0; i < gaps.size(); i++) {
+        out.frame.append(literals[i]);
+        if (gaps[i] == kIdGap) {
+            // Ids are base32, nothing to escape
+            out.frame.push_back('"');
+            out.frame.append(id.c_str(), id.size());
+            out.frame.push_back('"');
+        }
+        else {
+            out.frame.append(values[gaps[i]]);
+        }
+    }
+    out.frame.append(literals.back());
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+// include/MessageTemplate.h
+#ifndef MESSAGE_TEMPLATE_H
+#define MESSAGE_TEMPLATE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <cjson/cJSON.h>
+
+#include "SignalingProtocol.h"
+#include "MessageId.h"
+
+// A serialized message ready for SignalingClient. Metadata can still be
+// added, which is how the reliability layer stamps seq and ack.
+class PreparedMessage {
+public:
+    PreparedMessage();
+
+    SignalingMessageType getType() const { return type; }
+    void addMetadata(const std::string& key, const std::string& value);
+    const std::string& serialize() const { return frame; }
+
+private:
+    friend class MessageTemplate;
+
+    SignalingMessageType type;
+    std::string frame;              // Always ends with the metadata object
+    bool metadataEmpty;
+};
+
+// Recurring message whose shape never changes, only a few values.
+//
+// The skeleton (type, payload with slot placeholders, fixed metadata) is
+// serialized once by compile(); each send copies the literal pieces and
+// the current slot values into one buffer. Numbers are formatted with
+// std::to_chars, so a render builds no cJSON tree and allocates only the
+// frame. Output is compact JSON with the same fields serialize() writes.
+//
+// Not thread-safe: each sending thread keeps its own templates.
+class MessageTemplate {
+public:
+    explicit MessageTemplate(SignalingMessageType type);
+
+    // Placeholder for the given slot, to put in a payload skeleton
+    static cJSON* slot(size_t index);
+
+    // Serialize the skeleton; throws if it cannot. The payload is not kept.
+    void compile(const cJSON* payload,
+        const std::map<std::string, std::string>& metadata = std::map<std::string, std::string>());
+
+    // Slot values; unset slots render as null
+    void setInt(size_t index, int64_t value);
+    void setDouble(size_t index, double value);
+    void setBool(size_t index, bool value);
+    void setString(size_t index, const std::string& value);
+
+    // Serialized JSON of a whole value; takes ownership of json
+    void setJson(size_t index, cJSON* json);
+
+    void render(const MessageId& id, PreparedMessage& out) const;
+
+private:
+    SignalingMessageType type;
+
+    // literals[i] precedes gap i, with one literal after the last gap
+    std::vector<std::string> literals;
+    std::vector<int> gaps;              // Slot per gap; kIdGap = message id
+    std::vector<std::string> values;
+    bool metadataEmpty;
+
+    static const int kIdGap = -1;
+};
+
+#endif // MESSAGE_TEMPLATE_H
\ No newline at end of file
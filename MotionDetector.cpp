@@ -0,0 +1,300 @@
+// src/MotionDetector.cpp
+#include "MotionDetector.h"
+#include "Logger.h"
+#include "Watchdog.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    // Consecutive busy frames before motion is reported
+    const int kStartFrames = 2;
+
+    // A block busy for this many frames in a row is part of the scene
+    // now (a parked car, a moved chair) and starts blending in
+    const uint16_t kAbsorbFrames = 50;
+
+    const int kPollTimeoutMs = 500;
+    const int kReopenDelayMs = 1000;
+
+    int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Sum of absolute differences over one 16x16 block
+    uint32_t blockSad(const uint8_t* a, const uint8_t* b, size_t stride) {
+#if defined(__SSE2__)
+        __m128i sum = _mm_setzero_si128();
+        for (int row = 0; row < 16; row++) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + row * stride));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + row * stride));
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+        }
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(sum) +
+            _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+#elif defined(__ARM_NEON)
+        // 32 widening adds of at most 255 per lane fit in 16 bits
+        uint16x8_t sum = vdupq_n_u16(0);
+        for (int row = 0; row < 16; row++) {
+            uint8x16_t va = vld1q_u8(a + row * stride);
+            uint8x16_t vb = vld1q_u8(b + row * stride);
+            sum = vabal_u8(sum, vget_low_u8(va), vget_low_u8(vb));
+            sum = vabal_u8(sum, vget_high_u8(va), vget_high_u8(vb));
+        }
+        uint64x2_t total = vpaddlq_u32(vpaddlq_u16(sum));
+        return static_cast<uint32_t>(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+#else
+        uint32_t sum = 0;
+        for (int row = 0; row < 16; row++) {
+            for (int col = 0; col < 16; col++) {
+                int diff = a[row * stride + col] - b[row * stride + col];
+                sum += static_cast<uint32_t>(diff < 0 ? -diff : diff);
+            }
+        }
+        return sum;
+#endif
+    }
+
+    // background += (frame - background) / 8 over one 16x16 block,
+    // as three rounding averages
+    void blendBlock(uint8_t* background, const uint8_t* frame, size_t stride) {
+        for (int row = 0; row < 16; row++) {
+            uint8_t* bg = background + row * stride;
+            const uint8_t* in = frame + row * stride;
+#if defined(__SSE2__)
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bg));
+            __m128i blend = _mm_avg_epu8(vb, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+            blend = _mm_avg_epu8(vb, blend);
+            blend = _mm_avg_epu8(vb, blend);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bg), blend);
+#elif defined(__ARM_NEON)
+            uint8x16_t vb = vld1q_u8(bg);
+            uint8x16_t blend = vrhaddq_u8(vb, vld1q_u8(in));
+            blend = vrhaddq_u8(vb, blend);
+            blend = vrhaddq_u8(vb, blend);
+            vst1q_u8(bg, blend);
+#else
+            for (int col = 0; col < 16; col++) {
+                bg[col] = static_cast<uint8_t>((bg[col] * 7 + in[col] + 4) >> 3);
+            }
+#endif
+        }
+    }
+}
+
+cJSON* MotionEvent::toJson() const {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "event", "motion");
+    cJSON_AddStringToObject(json, "state", active ? "start" : "end");
+    cJSON_AddNumberToObject(json, "score", score);
+
+    if (active) {
+        cJSON* region = cJSON_AddObjectToObject(json, "region");
+        cJSON_AddNumberToObject(region, "x", x);
+        cJSON_AddNumberToObject(region, "y", y);
+        cJSON_AddNumberToObject(region, "width", width);
+        cJSON_AddNumberToObject(region, "height", height);
+    }
+    return json;
+}
+
+// Constructor and Destructor
+MotionDetector::MotionDetector(const DeviceConfig::MotionSettings& motionSettings)
+    : settings(motionSettings),
+    blocksX(motionSettings.width / kBlockSize),
+    blocksY(motionSettings.height / kBlockSize),
+    haveBackground(false),
+    active(false),
+    consecutiveBusyFrames(0),
+    lastMotionMs(0),
+    running(false) {
+
+    // Partial blocks at the right and bottom edges are not analysed
+    background.resize(static_cast<size_t>(settings.width) * settings.height);
+    busyFrames.resize(static_cast<size_t>(blocksX) * blocksY);
+}
+
+MotionDetector::~MotionDetector() {
+    stop();
+}
+
+// Analysis Thread
+void MotionDetector::start(const ThreadPolicy& policy, EventCallback callback) {
+    if (blocksX == 0 || blocksY == 0 || running.exchange(true)) {
+        return;
+    }
+
+    eventCallback = callback;
+    analysisThread = std::thread(&MotionDetector::runAnalysis, this, policy);
+}
+
+void MotionDetector::stop() {
+    running = false;
+    if (analysisThread.joinable()) {
+        analysisThread.join();
+    }
+}
+
+void MotionDetector::runAnalysis(ThreadPolicy policy) {
+    policy.apply();
+    WatchdogLease watchdog(policy.name.c_str());
+
+    const size_t frameSize = background.size();
+    const int64_t periodMs = 1000 / std::max(settings.fps, 1);
+
+    std::vector<uint8_t> frame(frameSize);
+    size_t filled = 0;
+    int64_t nextDueMs = 0;
+    bool warned = false;
+    int fd = -1;
+
+    while (running) {
+        watchdog.kick();
+
+        if (fd < 0) {
+            fd = open(settings.source.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                if (!warned) {
+                    LOG_WARN("Motion: cannot open luma source %s: %s",
+                        settings.source, strerror(errno));
+                    warned = true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(kReopenDelayMs));
+                continue;
+            }
+            filled = 0;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        ssize_t n = read(fd, frame.data() + filled, frameSize - filled);
+        if (n > 0) {
+            filled += static_cast<size_t>(n);
+            if (filled < frameSize) {
+                continue;
+            }
+            filled = 0;
+
+            // Frames beyond the analysis rate are read and discarded
+            int64_t now = nowMs();
+            if (now < nextDueMs) {
+                continue;
+            }
+            nextDueMs = now + periodMs;
+
+            MotionEvent event;
+            if (processFrame(frame.data(), now, event) && eventCallback) {
+                eventCallback(event);
+            }
+        }
+        else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            // Writer went away; wait for the pipeline to come back
+            close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(kReopenDelayMs));
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Detection
+bool MotionDetector::processFrame(const uint8_t* luma, int64_t timestampMs, MotionEvent& event) {
+    const size_t stride = static_cast<size_t>(settings.width);
+
+    if (!haveBackground) {
+        memcpy(background.data(), luma, background.size());
+        haveBackground = true;
+        return false;
+    }
+
+    const uint32_t blockThreshold =
+        static_cast<uint32_t>(settings.pixelThreshold) * kBlockSize * kBlockSize;
+
+    int changed = 0;
+    int minX = blocksX, minY = blocksY, maxX = -1, maxY = -1;
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            size_t offset = static_cast<size_t>(by) * kBlockSize * stride + bx * kBlockSize;
+            bool busy = blockSad(luma + offset, background.data() + offset, stride) > blockThreshold;
+            uint16_t& streak = busyFrames[by * blocksX + bx];
+
+            // Still blocks track lighting; long-busy ones are absorbed
+            if (!busy) {
+                streak = 0;
+            }
+            else if (streak < kAbsorbFrames) {
+                streak++;
+            }
+            if (!busy || streak >= kAbsorbFrames) {
+                blendBlock(background.data() + offset, luma + offset, stride);
+            }
+
+            if (busy) {
+                changed++;
+                minX = std::min(minX, bx);
+                minY = std::min(minY, by);
+                maxX = std::max(maxX, bx);
+                maxY = std::max(maxY, by);
+            }
+        }
+    }
+
+    double score = static_cast<double>(changed) / (blocksX * blocksY);
+    bool busyFrame = score >= settings.areaThreshold;
+    consecutiveBusyFrames = busyFrame ? consecutiveBusyFrames + 1 : 0;
+
+    if (!active) {
+        if (consecutiveBusyFrames < kStartFrames) {
+            return false;
+        }
+
+        active = true;
+        lastMotionMs = timestampMs;
+        event.active = true;
+        event.score = score;
+        event.x = minX * kBlockSize;
+        event.y = minY * kBlockSize;
+        event.width = (maxX - minX + 1) * kBlockSize;
+        event.height = (maxY - minY + 1) * kBlockSize;
+        return true;
+    }
+
+    if (busyFrame) {
+        lastMotionMs = timestampMs;
+        return false;
+    }
+
+    if (timestampMs - lastMotionMs < settings.holdMs) {
+        return false;
+    }
+
+    active = false;
+    event.active = false;
+    event.score = score;
+    return true;
+}
+
+bool MotionDetector::isActive() const {
+    return active;
+}
\ No newline at end of file
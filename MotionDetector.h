@@ -0,0 +1,78 @@
+// include/MotionDetector.h
+#ifndef MOTION_DETECTOR_H
+#define MOTION_DETECTOR_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+#include "DeviceConfig.h"
+#include "ThreadPolicy.h"
+
+// Start or end of a motion period
+struct MotionEvent {
+    bool active = false;
+    double score = 0.0;         // Fraction of blocks that changed
+    int x = 0;                  // Bounding box of changed blocks, in
+    int y = 0;                  // luma-plane pixels
+    int width = 0;
+    int height = 0;
+
+    cJSON* toJson() const;
+};
+
+// Block-based motion detection on a downscaled luma plane.
+//
+// Each frame is compared against a running background in 16x16 blocks
+// using SIMD sums of absolute differences (SSE2 psadbw or NEON vabal).
+// A block whose mean difference exceeds pixelThreshold has changed;
+// motion starts when enough blocks change and ends after holdMs with
+// none. Still blocks blend into the background at 1/8 per frame; a
+// block that stays busy long enough blends in too, so a parked car
+// eventually stops counting while passing objects never burn in.
+//
+// Frames come as raw 8-bit luma from a FIFO written by the capture
+// pipeline (the ISP's secondary scaler output); analysis runs on its
+// own thread at the configured rate.
+class MotionDetector {
+public:
+    typedef std::function<void(const MotionEvent&)> EventCallback;
+
+    explicit MotionDetector(const DeviceConfig::MotionSettings& settings);
+    ~MotionDetector();
+
+    // Analysis thread
+    void start(const ThreadPolicy& policy, EventCallback callback);
+    void stop();
+
+    // Feed one width x height luma frame; true if the motion state changed
+    bool processFrame(const uint8_t* luma, int64_t timestampMs, MotionEvent& event);
+
+    bool isActive() const;
+
+private:
+    static const int kBlockSize = 16;
+
+    DeviceConfig::MotionSettings settings;
+    int blocksX;
+    int blocksY;
+
+    std::vector<uint8_t> background;
+    std::vector<uint16_t> busyFrames;
+    bool haveBackground;
+
+    std::atomic<bool> active;
+    int consecutiveBusyFrames;
+    int64_t lastMotionMs;
+
+    std::atomic<bool> running;
+    std::thread analysisThread;
+    EventCallback eventCallback;
+
+    void runAnalysis(ThreadPolicy policy);
+};
+
+#endif // MOTION_DETECTOR_H
\ No newline at end of file
@@ -0,0 +1,280 @@
+// src/NetworkImpairment.cpp
+#include "NetworkImpairment.h"
+#include <algorithm>
+#include <stdexcept>
+#include <climits>
+#include <cstdio>
+
+namespace {
+    // How far past its successors a reordered packet is held
+    const int64_t kReorderHoldUs = 10000;
+
+    // Freeze threshold floor above the mean frame interval
+    const int64_t kFreezeMarginUs = 150000;
+
+    const LinkProfile kUnimpaired;
+
+    int intField(const cJSON* json, const char* name, int fallback) {
+        const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, name);
+        return cJSON_IsNumber(item) ? item->valueint : fallback;
+    }
+
+    double doubleField(const cJSON* json, const char* name, double fallback) {
+        const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, name);
+        return cJSON_IsNumber(item) ? item->valuedouble : fallback;
+    }
+
+    bool boolField(const cJSON* json, const char* name, bool fallback) {
+        const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, name);
+        return cJSON_IsBool(item) ? cJSON_IsTrue(item) : fallback;
+    }
+
+    int64_t percentile(std::vector<int64_t>& values, double fraction) {
+        if (values.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(fraction * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+}
+
+// LinkProfile
+LinkProfile LinkProfile::fromJson(const cJSON* json, const LinkProfile& base) {
+    LinkProfile profile = base;
+    profile.delayMs = std::max(0, intField(json, "delay_ms", base.delayMs));
+    profile.jitterMs = std::max(0, intField(json, "jitter_ms", base.jitterMs));
+    profile.loss = std::min(1.0, std::max(0.0, doubleField(json, "loss", base.loss)));
+    profile.burstLength = std::max(1.0, doubleField(json, "burst_length", base.burstLength));
+    profile.reorder = std::min(1.0, std::max(0.0, doubleField(json, "reorder", base.reorder)));
+    profile.bandwidthKbps = std::max(0, intField(json, "bandwidth_kbps", base.bandwidthKbps));
+    profile.queueMs = std::max(0, intField(json, "queue_ms", base.queueMs));
+    profile.down = boolField(json, "down", base.down);
+    return profile;
+}
+
+// ImpairedLink
+ImpairedLink::ImpairedLink(uint64_t seed)
+    : random(seed),
+    unit(0.0, 1.0),
+    inBurst(false),
+    queueFreeUs(0),
+    lastArrivalUs(0),
+    sent(0),
+    dropped(0) {
+}
+
+void ImpairedLink::setProfile(const LinkProfile& newProfile) {
+    profile = newProfile;
+}
+
+bool ImpairedLink::lose() {
+    if (profile.loss <= 0.0) {
+        inBurst = false;
+        return false;
+    }
+    if (profile.loss >= 1.0) {
+        return true;
+    }
+
+    // Gilbert model: the bad state loses everything and lasts burstLength
+    // packets on average; entering it at this rate gives the mean loss
+    double leave = 1.0 / profile.burstLength;
+    double enter = profile.loss * leave / (1.0 - profile.loss);
+
+    if (inBurst) {
+        inBurst = unit(random) >= leave;
+    }
+    else {
+        inBurst = unit(random) < enter;
+    }
+    return inBurst;
+}
+
+int64_t ImpairedLink::transmit(int64_t nowUs, size_t bytes) {
+    sent++;
+    if (profile.down || lose()) {
+        dropped++;
+        return -1;
+    }
+
+    // Serialise through the bottleneck; a full queue tail-drops
+    int64_t departUs = nowUs;
+    if (profile.bandwidthKbps > 0) {
+        int64_t startUs = std::max(nowUs, queueFreeUs);
+        if (startUs - nowUs > static_cast<int64_t>(profile.queueMs) * 1000) {
+            dropped++;
+            return -1;
+        }
+        queueFreeUs = startUs + static_cast<int64_t>(bytes) * 8000 / profile.bandwidthKbps;
+        departUs = queueFreeUs;
+    }
+
+    int64_t delayUs = static_cast<int64_t>(profile.delayMs) * 1000;
+    if (profile.jitterMs > 0) {
+        delayUs += static_cast<int64_t>((unit(random) * 2.0 - 1.0) * profile.jitterMs * 1000);
+    }
+    int64_t arrivalUs = departUs + std::max<int64_t>(0, delayUs);
+
+    // A reordered packet is held back and lets later ones pass it
+    if (profile.reorder > 0.0 && unit(random) < profile.reorder) {
+        int64_t holdUs = kReorderHoldUs + static_cast<int64_t>(profile.jitterMs) * 1000;
+        return std::max(arrivalUs, lastArrivalUs) + static_cast<int64_t>(holdUs * (0.5 + unit(random)));
+    }
+
+    // Jitter alone does not reorder a path
+    arrivalUs = std::max(arrivalUs, lastArrivalUs);
+    lastArrivalUs = arrivalUs;
+    return arrivalUs;
+}
+
+// Scenario
+Scenario Scenario::loadFromFile(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        throw std::runtime_error("Could not open scenario file");
+    }
+
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(file);
+
+    cJSON* json = cJSON_Parse(text.c_str());
+    if (!json) {
+        throw std::runtime_error("Failed to parse scenario JSON");
+    }
+
+    Scenario scenario;
+    const cJSON* seed = cJSON_GetObjectItemCaseSensitive(json, "seed");
+    if (cJSON_IsNumber(seed)) {
+        scenario.seed = static_cast<uint64_t>(seed->valuedouble);
+    }
+    scenario.durationMs = std::max(1, intField(json, "duration_ms", static_cast<int>(scenario.durationMs)));
+
+    const cJSON* media = cJSON_GetObjectItemCaseSensitive(json, "media");
+    if (cJSON_IsObject(media)) {
+        scenario.fps = std::max(1, intField(media, "fps", scenario.fps));
+        scenario.gop = std::max(1, intField(media, "gop", scenario.gop));
+        scenario.bitrateKbps = std::max(1, intField(media, "bitrate_kbps", scenario.bitrateKbps));
+    }
+
+    std::vector<const cJSON*> timeline;
+    const cJSON* steps = cJSON_GetObjectItemCaseSensitive(json, "timeline");
+    const cJSON* step = nullptr;
+    cJSON_ArrayForEach(step, steps) {
+        if (cJSON_IsObject(step)) {
+            timeline.push_back(step);
+        }
+    }
+    std::stable_sort(timeline.begin(), timeline.end(), [](const cJSON* a, const cJSON* b) {
+        return intField(a, "at_ms", 0) < intField(b, "at_ms", 0);
+    });
+
+    // Each step builds on the conditions before it
+    LinkProfile current;
+    for (const cJSON* item : timeline) {
+        current = LinkProfile::fromJson(item, current);
+        scenario.steps.push_back({ std::max(0, intField(item, "at_ms", 0)), current });
+    }
+
+    cJSON_Delete(json);
+    return scenario;
+}
+
+const LinkProfile& Scenario::profileAt(int64_t ms) const {
+    const LinkProfile* profile = &kUnimpaired;
+    for (const Step& step : steps) {
+        if (step.atMs > ms) {
+            break;
+        }
+        profile = &step.profile;
+    }
+    return *profile;
+}
+
+// MediaMetrics
+void MediaMetrics::packetSent(uint32_t frameTimestamp, int64_t sentUs, bool keyframe) {
+    packetsSent++;
+
+    auto it = frameIndex.find(frameTimestamp);
+    if (it == frameIndex.end()) {
+        it = frameIndex.emplace(frameTimestamp, frames.size()).first;
+        frames.emplace_back();
+        frames.back().firstSentUs = sentUs;
+    }
+
+    Frame& frame = frames[it->second];
+    frame.packets++;
+    frame.keyframe = frame.keyframe || keyframe;
+}
+
+void MediaMetrics::packetArrived(uint32_t frameTimestamp, int64_t arrivalUs) {
+    auto it = frameIndex.find(frameTimestamp);
+    if (it == frameIndex.end()) {
+        return;
+    }
+
+    packetsArrived++;
+    Frame& frame = frames[it->second];
+    frame.arrived++;
+    frame.completeUs = std::max(frame.completeUs, arrivalUs);
+}
+
+cJSON* MediaMetrics::toJson() const {
+    // Play the frames out in order; a gap in the chain waits for a keyframe
+    std::vector<int64_t> renderUs;
+    std::vector<int64_t> latencyUs;
+    bool decoding = false;
+    int64_t lastRenderUs = INT64_MIN;
+
+    for (const Frame& frame : frames) {
+        if (frame.arrived < frame.packets) {
+            decoding = false;
+            continue;
+        }
+        if (!decoding && !frame.keyframe) {
+            continue;
+        }
+        decoding = true;
+
+        lastRenderUs = std::max(frame.completeUs, lastRenderUs);
+        renderUs.push_back(lastRenderUs);
+        latencyUs.push_back(lastRenderUs - frame.firstSentUs);
+    }
+
+    int freezes = 0;
+    int64_t freezeUs = 0;
+    if (renderUs.size() > 1) {
+        int64_t meanUs = (renderUs.back() - renderUs.front()) / static_cast<int64_t>(renderUs.size() - 1);
+        int64_t thresholdUs = std::max(3 * meanUs, meanUs + kFreezeMarginUs);
+        for (size_t i = 1; i < renderUs.size(); i++) {
+            int64_t gapUs = renderUs[i] - renderUs[i - 1];
+            if (gapUs > thresholdUs) {
+                freezes++;
+                freezeUs += gapUs;
+            }
+        }
+    }
+
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "frames_sent", static_cast<double>(frames.size()));
+    cJSON_AddNumberToObject(json, "frames_rendered", static_cast<double>(renderUs.size()));
+    cJSON_AddNumberToObject(json, "time_to_first_frame_ms", renderUs.empty() ? -1.0 :
+        static_cast<double>((renderUs.front() - frames.front().firstSentUs) / 1000));
+
+    cJSON* latency = cJSON_CreateObject();
+    cJSON_AddNumberToObject(latency, "p50", static_cast<double>(percentile(latencyUs, 0.50) / 1000));
+    cJSON_AddNumberToObject(latency, "p95", static_cast<double>(percentile(latencyUs, 0.95) / 1000));
+    cJSON_AddNumberToObject(latency, "max", static_cast<double>(percentile(latencyUs, 1.0) / 1000));
+    cJSON_AddItemToObject(json, "latency_ms", latency);
+
+    cJSON_AddNumberToObject(json, "freezes", freezes);
+    cJSON_AddNumberToObject(json, "freeze_ms", static_cast<double>(freezeUs / 1000));
+    cJSON_AddNumberToObject(json, "packets_sent", static_cast<double>(packetsSent));
+    cJSON_AddNumberToObject(json, "packets_lost", static_cast<double>(packetsSent - packetsArrived));
+    return json;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+// include/NetworkImpairment.h
+#ifndef NETWORK_IMPAIRMENT_H
+#define NETWORK_IMPAIRMENT_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <unordered_map>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+// Conditions on one direction of a link
+struct LinkProfile {
+    int delayMs = 0;
+    int jitterMs = 0;               // Uniform +/- around the delay
+    double loss = 0.0;              // Long-run packet loss fraction
+    double burstLength = 1.0;       // Mean packets lost per loss event
+    double reorder = 0.0;           // Fraction delivered late, out of order
+    int bandwidthKbps = 0;          // 0 = unlimited
+    int queueMs = 200;              // Bottleneck queue; overflow is dropped
+    bool down = false;              // Outage: nothing gets through
+
+    // Fields present in json override those of base
+    static LinkProfile fromJson(const cJSON* json, const LinkProfile& base);
+};
+
+// Seeded model of one link direction.
+//
+// Time is passed in by the caller, so the same seed and the same sequence
+// of transmit() calls give the same result whether the clock is a
+// simulated one or the wall clock. Loss follows a two-state (Gilbert)
+// model so bursts can be tuned apart from the average rate; the
+// bandwidth cap is a serialising queue that tail-drops past queueMs.
+class ImpairedLink {
+public:
+    explicit ImpairedLink(uint64_t seed);
+
+    void setProfile(const LinkProfile& profile);
+    const LinkProfile& getProfile() const { return profile; }
+
+    // Arrival time of a packet of the given size sent at nowUs, or -1 if
+    // the link drops it
+    int64_t transmit(int64_t nowUs, size_t bytes);
+
+    uint64_t getSent() const { return sent; }
+    uint64_t getDropped() const { return dropped; }
+
+private:
+    std::mt19937_64 random;
+    std::uniform_real_distribution<double> unit;
+    LinkProfile profile;
+
+    bool inBurst;
+    int64_t queueFreeUs;            // When the bottleneck is next idle
+    int64_t lastArrivalUs;          // Keeps in-order delivery in order
+
+    uint64_t sent;
+    uint64_t dropped;
+
+    bool lose();
+};
+
+// Scripted conditions over time, from a JSON file:
+//
+// {"seed": 1, "duration_ms": 60000,
+//  "media": {"fps": 25, "gop": 50, "bitrate_kbps": 2000},
+//  "timeline": [{"at_ms": 0, "delay_ms": 40, "jitter_ms": 10, "loss": 0.01},
+//               {"at_ms": 20000, "down": true},
+//               {"at_ms": 23000, "down": false, "bandwidth_kbps": 1500}]}
+//
+// Each step changes only the fields it names.
+struct Scenario {
+    struct Step {
+        int64_t atMs;
+        LinkProfile profile;
+    };
+
+    uint64_t seed = 1;
+    int64_t durationMs = 30000;
+    int fps = 25;
+    int gop = 50;
+    int bitrateKbps = 2000;
+    std::vector<Step> steps;
+
+    static Scenario loadFromFile(const std::string& path);
+
+    // Profile in force at the given time
+    const LinkProfile& profileAt(int64_t ms) const;
+};
+
+// Viewer-side video quality from packet departures and arrivals.
+//
+// Frames are keyed by RTP timestamp and rendered in order as soon as all
+// their packets are in; a frame with a missing packet stops decoding
+// until the next keyframe. Reports time to first frame, render latency
+// and freezes, using the WebRTC definition: a gap between rendered
+// frames longer than max(3 x mean interval, mean interval + 150 ms).
+class MediaMetrics {
+public:
+    void packetSent(uint32_t frameTimestamp, int64_t sentUs, bool keyframe);
+    void packetArrived(uint32_t frameTimestamp, int64_t arrivalUs);
+
+    // {"frames_sent": n, "frames_rendered": n, "time_to_first_frame_ms": n,
+    //  "latency_ms": {"p50": n, "p95": n, "max": n},
+    //  "freezes": n, "freeze_ms": n, "packets_sent": n, "packets_lost": n}
+    cJSON* toJson() const;
+
+private:
+    struct Frame {
+        int64_t firstSentUs = 0;
+        int64_t completeUs = 0;
+        int packets = 0;
+        int arrived = 0;
+        bool keyframe = false;
+    };
+
+    std::vector<Frame> frames;
+    std::unordered_map<uint32_t, size_t> frameIndex;
+    uint64_t packetsSent = 0;
+    uint64_t packetsArrived = 0;
+};
+
+#endif // NETWORK_IMPAIRMENT_H
\ No newline at end of file
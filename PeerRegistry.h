@@ -0,0 +1,285 @@
+// include/PeerRegistry.h
+#ifndef PEER_REGISTRY_H
+#define PEER_REGISTRY_H
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#include "EpochManager.h"
+
+// Concurrent id -> peer map for the signaling server.
+//
+// Each shard is an open-addressing table with linear probing. Writers
+// (register/unregister) serialize on the shard mutex; readers never lock
+// and finish in a bounded number of probes, so lookups are wait-free.
+// Tables, entries and peers are reclaimed through EpochManager, so find()
+// must be called inside an EpochGuard and its result used only within it.
+//
+// Ids are interned: each entry stores its key inline, allocated once at
+// registration. A registered peer costs one slot (16 bytes) plus an entry
+// of 16 bytes + id length, at a load factor of at most 0.7.
+template <typename T>
+class PeerRegistry {
+public:
+    explicit PeerRegistry(unsigned int shardCount, size_t initialCapacity = 64);
+    ~PeerRegistry();
+
+    // Writers. insert() returns the peer it displaced, if any.
+    T* insert(const std::string& id, T* value);
+    bool remove(const std::string& id, const T* expected);
+
+    // Readers; caller holds an EpochGuard
+    T* find(const char* id, size_t length) const;
+    T* find(const std::string& id) const { return find(id.data(), id.size()); }
+
+    size_t size() const;
+
+private:
+    // Interned id plus the current owner
+    struct Entry {
+        std::atomic<T*> value;
+        uint32_t length;
+        char key[1];
+
+        static Entry* create(const std::string& id, T* value) {
+            void* memory = ::operator new(offsetof(Entry, key) + id.size() + 1);
+            Entry* entry = static_cast<Entry*>(memory);
+            new (&entry->value) std::atomic<T*>(value);
+            entry->length = static_cast<uint32_t>(id.size());
+            memcpy(entry->key, id.data(), id.size());
+            entry->key[id.size()] = '\0';
+            return entry;
+        }
+
+        static void destroy(void* memory) {
+            ::operator delete(memory);
+        }
+
+        bool matches(const char* id, size_t idLength) const {
+            return length == idLength && memcmp(key, id, idLength) == 0;
+        }
+    };
+
+    // hash == 0: empty. hash set with entry == nullptr: tombstone.
+    struct Slot {
+        std::atomic<uint64_t> hash;
+        std::atomic<Entry*> entry;
+    };
+
+    struct Table {
+        size_t mask;
+        size_t used;        // Live entries plus tombstones
+        std::unique_ptr<Slot[]> slots;
+
+        explicit Table(size_t capacity)
+            : mask(capacity - 1), used(0), slots(new Slot[capacity]()) {}
+
+        static void destroy(void* memory) {
+            delete static_cast<Table*>(memory);
+        }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex writeMutex;
+        std::atomic<Table*> table;
+        std::atomic<size_t> live;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    unsigned int shardBits;
+
+    static uint64_t hashId(const char* id, size_t length);
+    Shard& shardFor(uint64_t hash) const;
+
+    static void insertSlot(Table* table, uint64_t hash, Entry* entry);
+    void rehash(Shard& shard, size_t capacity);
+};
+
+// Hashing
+template <typename T>
+uint64_t PeerRegistry<T>::hashId(const char* id, size_t length) {
+    // FNV-1a; zero is reserved for empty slots
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(id[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+template <typename T>
+typename PeerRegistry<T>::Shard& PeerRegistry<T>::shardFor(uint64_t hash) const {
+    // High bits pick the shard, low bits the slot
+    return shards[shardBits ? (hash >> (64 - shardBits)) : 0];
+}
+
+// Constructor and Destructor
+template <typename T>
+PeerRegistry<T>::PeerRegistry(unsigned int shardCount, size_t initialCapacity)
+    : shardBits(0) {
+    while ((1u << shardBits) < shardCount) {
+        shardBits++;
+    }
+
+    size_t capacity = 8;
+    while (capacity < initialCapacity) {
+        capacity <<= 1;
+    }
+
+    shards.reset(new Shard[1u << shardBits]);
+    for (unsigned int i = 0; i < (1u << shardBits); i++) {
+        shards[i].table.store(new Table(capacity), std::memory_order_relaxed);
+        shards[i].live.store(0, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+PeerRegistry<T>::~PeerRegistry() {
+    // Owners of the peers are responsible for them; only free our storage
+    for (unsigned int i = 0; i < (1u << shardBits); i++) {
+        Table* table = shards[i].table.load(std::memory_order_relaxed);
+        for (size_t s = 0; s <= table->mask; s++) {
+            Entry::destroy(table->slots[s].entry.load(std::memory_order_relaxed));
+        }
+        delete table;
+    }
+}
+
+// Writers
+template <typename T>
+void PeerRegistry<T>::insertSlot(Table* table, uint64_t hash, Entry* entry) {
+    size_t index = hash & table->mask;
+    while (table->slots[index].hash.load(std::memory_order_relaxed) != 0) {
+        index = (index + 1) & table->mask;
+    }
+
+    // Publish the entry before the hash that makes it reachable
+    table->slots[index].entry.store(entry, std::memory_order_release);
+    table->slots[index].hash.store(hash, std::memory_order_release);
+    table->used++;
+}
+
+template <typename T>
+void PeerRegistry<T>::rehash(Shard& shard, size_t capacity) {
+    Table* oldTable = shard.table.load(std::memory_order_relaxed);
+    Table* newTable = new Table(capacity);
+
+    // Entries move by pointer; tombstones are dropped
+    for (size_t s = 0; s <= oldTable->mask; s++) {
+        Entry* entry = oldTable->slots[s].entry.load(std::memory_order_relaxed);
+        if (entry) {
+            insertSlot(newTable, oldTable->slots[s].hash.load(std::memory_order_relaxed), entry);
+        }
+    }
+
+    shard.table.store(newTable, std::memory_order_release);
+    EpochManager::instance().retire(oldTable, &Table::destroy);
+}
+
+template <typename T>
+T* PeerRegistry<T>::insert(const std::string& id, T* value) {
+    uint64_t hash = hashId(id.data(), id.size());
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+    Table* table = shard.table.load(std::memory_order_relaxed);
+
+    // Re-registration swaps the owner in place; the interned key is kept
+    size_t index = hash & table->mask;
+    uint64_t slotHash;
+    while ((slotHash = table->slots[index].hash.load(std::memory_order_relaxed)) != 0) {
+        Entry* entry = table->slots[index].entry.load(std::memory_order_relaxed);
+        if (slotHash == hash && entry && entry->matches(id.data(), id.size())) {
+            return entry->value.exchange(value, std::memory_order_acq_rel);
+        }
+        index = (index + 1) & table->mask;
+    }
+
+    // Keep the load factor (tombstones included) at or below 0.7
+    size_t capacity = table->mask + 1;
+    if ((table->used + 1) * 10 > capacity * 7) {
+        size_t live = shard.live.load(std::memory_order_relaxed) + 1;
+        size_t newCapacity = capacity;
+        while (live * 10 > newCapacity * 7 / 2) {
+            newCapacity <<= 1;
+        }
+        rehash(shard, newCapacity);
+        table = shard.table.load(std::memory_order_relaxed);
+    }
+
+    insertSlot(table, hash, Entry::create(id, value));
+    shard.live.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+template <typename T>
+bool PeerRegistry<T>::remove(const std::string& id, const T* expected) {
+    uint64_t hash = hashId(id.data(), id.size());
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+    Table* table = shard.table.load(std::memory_order_relaxed);
+
+    size_t index = hash & table->mask;
+    uint64_t slotHash;
+    while ((slotHash = table->slots[index].hash.load(std::memory_order_relaxed)) != 0) {
+        Entry* entry = table->slots[index].entry.load(std::memory_order_relaxed);
+        if (slotHash == hash && entry && entry->matches(id.data(), id.size())) {
+            // Only the current owner may unregister the id
+            if (entry->value.load(std::memory_order_relaxed) != expected) {
+                return false;
+            }
+
+            table->slots[index].entry.store(nullptr, std::memory_order_release);
+            shard.live.fetch_sub(1, std::memory_order_relaxed);
+            EpochManager::instance().retire(entry, &Entry::destroy);
+            return true;
+        }
+        index = (index + 1) & table->mask;
+    }
+
+    return false;
+}
+
+// Readers
+template <typename T>
+T* PeerRegistry<T>::find(const char* id, size_t length) const {
+    uint64_t hash = hashId(id, length);
+    const Shard& shard = shardFor(hash);
+    const Table* table = shard.table.load(std::memory_order_acquire);
+
+    // At most one pass over the table; in practice one or two probes
+    size_t index = hash & table->mask;
+    for (size_t probes = 0; probes <= table->mask; probes++) {
+        uint64_t slotHash = table->slots[index].hash.load(std::memory_order_acquire);
+        if (slotHash == 0) {
+            return nullptr;
+        }
+
+        if (slotHash == hash) {
+            Entry* entry = table->slots[index].entry.load(std::memory_order_acquire);
+            if (entry && entry->matches(id, length)) {
+                return entry->value.load(std::memory_order_acquire);
+            }
+        }
+        index = (index + 1) & table->mask;
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+size_t PeerRegistry<T>::size() const {
+    size_t total = 0;
+    for (unsigned int i = 0; i < (1u << shardBits); i++) {
+        total += shards[i].live.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+#endif // PEER_REGISTRY_H
\ No newline at end of file
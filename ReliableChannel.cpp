@@ -0,0 +1,262 @@
+// src/ReliableChannel.cpp
+#include "ReliableChannel.h"
+#include "MessageTemplate.h"
+#include "Logger.h"
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+    // Returns 0 when the key is absent or malformed
+    uint64_t metadataNumber(const SignalingMessage& message, const char* key) {
+        std::string value = message.getMetadata(key);
+        return value.empty() ? 0 : strtoull(value.c_str(), nullptr, 10);
+    }
+}
+
+// Receive Window
+ReceiveWindow::ReceiveWindow()
+    : cumulativeSeq(0) {
+}
+
+ReceiveWindow::Result ReceiveWindow::accept(uint64_t seq) {
+    if (seq <= cumulativeSeq || outOfOrder.count(seq)) {
+        return Result::DUPLICATE;
+    }
+
+    if (seq != cumulativeSeq + 1) {
+        // Bounded so a misbehaving peer cannot grow the set forever; not
+        // acked, so the sender retransmits once the gap fills
+        if (outOfOrder.size() >= kMaxOutOfOrder) {
+            return Result::FULL;
+        }
+        outOfOrder.insert(seq);
+        return Result::FRESH;
+    }
+
+    // Advance through any gap that this fills
+    cumulativeSeq = seq;
+    while (!outOfOrder.empty() && *outOfOrder.begin() == cumulativeSeq + 1) {
+        cumulativeSeq++;
+        outOfOrder.erase(outOfOrder.begin());
+    }
+    return Result::FRESH;
+}
+
+uint64_t ReceiveWindow::cumulative() const {
+    return cumulativeSeq;
+}
+
+void ReceiveWindow::reset() {
+    cumulativeSeq = 0;
+    outOfOrder.clear();
+}
+
+// Constructor and Destructor
+ReliableChannel::ReliableChannel(TimerWheel& timerWheel, Transmit transmitFn, const Options& channelOptions)
+    : timers(timerWheel),
+    transmit(std::move(transmitFn)),
+    options(channelOptions),
+    nextSeq(1),
+    ackOwed(false),
+    ackTimer(0) {
+}
+
+ReliableChannel::~ReliableChannel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : unacked) {
+        timers.cancel(entry.second.timer);
+    }
+    if (ackTimer) {
+        timers.cancel(ackTimer);
+    }
+}
+
+bool ReliableChannel::isCritical(SignalingMessageType type) {
+    switch (type) {
+    case SignalingMessageType::REGISTER:
+    case SignalingMessageType::RESPONSE:
+    case SignalingMessageType::ANSWER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Outbound
+template <typename Message>
+std::string ReliableChannel::stamp(Message& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Kept unstamped: an ack or seq from this connection means nothing
+    // on the next one
+    bool critical = isCritical(message.getType());
+    PendingMessage pending;
+    if (critical) {
+        pending.restamp = [original = Message(message)](uint64_t newSeq) {
+            Message copy(original);
+            copy.addMetadata("seq", std::to_string(newSeq));
+            return copy.serialize();
+        };
+    }
+
+    // Piggyback whatever we owe; this makes a pending standalone ACK moot
+    uint64_t ack = receiveWindow.cumulative();
+    if (ack > 0) {
+        message.addMetadata("ack", std::to_string(ack));
+        ackOwed = false;
+    }
+
+    if (!critical) {
+        return message.serialize();
+    }
+
+    uint64_t seq = nextSeq++;
+    message.addMetadata("seq", std::to_string(seq));
+
+    pending.frame = message.serialize();
+    pending.attempts = 1;
+    pending.rtoMs = options.initialRtoMs;
+    pending.timer = timers.schedule(std::chrono::milliseconds(pending.rtoMs),
+        [this, seq]() { onRetransmitTimer(seq); });
+
+    std::string frame = pending.frame;
+    unacked.emplace(seq, std::move(pending));
+    return frame;
+}
+
+std::string ReliableChannel::prepareOutbound(SignalingMessage& message) {
+    return stamp(message);
+}
+
+std::string ReliableChannel::prepareOutbound(PreparedMessage& message) {
+    return stamp(message);
+}
+
+void ReliableChannel::onRetransmitTimer(uint64_t seq) {
+    std::string frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = unacked.find(seq);
+        if (it == unacked.end()) {
+            return;
+        }
+
+        PendingMessage& pending = it->second;
+        if (pending.attempts >= options.maxAttempts) {
+            LOG_ERROR("Giving up on signaling message seq %llu after %d attempts",
+                seq, pending.attempts);
+            unacked.erase(it);
+            return;
+        }
+
+        pending.attempts++;
+        pending.rtoMs = std::min(pending.rtoMs * 2, options.maxRtoMs);
+        pending.timer = timers.schedule(std::chrono::milliseconds(pending.rtoMs),
+            [this, seq]() { onRetransmitTimer(seq); });
+        frame = pending.frame;
+    }
+
+    transmit(frame);
+}
+
+void ReliableChannel::startSession() {
+    std::vector<std::string> frames;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // The peer's sequence numbers restart too
+        receiveWindow.reset();
+        ackOwed = false;
+        if (ackTimer) {
+            timers.cancel(ackTimer);
+            ackTimer = 0;
+        }
+
+        // Renumber in the original order, with a fresh retry budget
+        std::map<uint64_t, PendingMessage> renumbered;
+        nextSeq = 1;
+        for (auto& entry : unacked) {
+            PendingMessage& pending = entry.second;
+            timers.cancel(pending.timer);
+
+            uint64_t seq = nextSeq++;
+            pending.frame = pending.restamp(seq);
+            pending.attempts = 1;
+            pending.rtoMs = options.initialRtoMs;
+            pending.timer = timers.schedule(std::chrono::milliseconds(pending.rtoMs),
+                [this, seq]() { onRetransmitTimer(seq); });
+            frames.push_back(pending.frame);
+            renumbered.emplace(seq, std::move(pending));
+        }
+        unacked.swap(renumbered);
+    }
+
+    for (const auto& frame : frames) {
+        transmit(frame);
+    }
+}
+
+// Inbound
+bool ReliableChannel::processInbound(const SignalingMessage& message) {
+    uint64_t ack = metadataNumber(message, "ack");
+    if (ack > 0) {
+        handleAck(ack);
+    }
+
+    uint64_t seq = metadataNumber(message, "seq");
+    if (seq == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Duplicates still need acking: our earlier ack may have been lost
+    ReceiveWindow::Result result = receiveWindow.accept(seq);
+    if (result == ReceiveWindow::Result::FULL) {
+        LOG_WARN("Receive window full, dropping signaling message seq %u", seq);
+    }
+    ackOwed = true;
+
+    if (!ackTimer) {
+        ackTimer = timers.schedule(std::chrono::milliseconds(options.ackDelayMs),
+            [this]() { onAckTimer(); });
+    }
+
+    return result == ReceiveWindow::Result::FRESH;
+}
+
+void ReliableChannel::handleAck(uint64_t ack) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Cumulative: everything up to and including ack is delivered
+    auto end = unacked.upper_bound(ack);
+    for (auto it = unacked.begin(); it != end; ++it) {
+        timers.cancel(it->second.timer);
+    }
+    unacked.erase(unacked.begin(), end);
+}
+
+void ReliableChannel::onAckTimer() {
+    uint64_t ack;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ackTimer = 0;
+
+        ack = receiveWindow.cumulative();
+        if (!ackOwed || ack == 0) {
+            return;
+        }
+        ackOwed = false;
+    }
+
+    SignalingMessage ackMsg(SignalingMessageType::ACK, "ack-" + std::to_string(ack));
+    ackMsg.addMetadata("ack", std::to_string(ack));
+    transmit(ackMsg.serialize());
+}
+
+size_t ReliableChannel::unackedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return unacked.size();
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+// include/ReliableChannel.h
+#ifndef RELIABLE_CHANNEL_H
+#define RELIABLE_CHANNEL_H
+
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+#include "SignalingProtocol.h"
+#include "TimerWheel.h"
+
+class PreparedMessage;
+
+// Receive-side sequence tracking: cumulative ack point plus the few
+// sequence numbers that arrived beyond it
+class ReceiveWindow {
+public:
+    ReceiveWindow();
+
+    enum class Result {
+        FRESH,          // First time seen; deliver
+        DUPLICATE,      // Seen before; ack again, don't deliver
+        FULL            // Too far ahead of a gap to track; dropped unseen
+    };
+
+    Result accept(uint64_t seq);
+
+    // Every sequence number <= cumulative() has been received
+    uint64_t cumulative() const;
+
+    void reset();
+
+private:
+    static const size_t kMaxOutOfOrder = 256;
+
+    uint64_t cumulativeSeq;
+    std::set<uint64_t> outOfOrder;
+};
+
+// Retransmission and acknowledgement tuning
+struct ReliableChannelOptions {
+    int initialRtoMs = 1000;
+    int maxRtoMs = 8000;
+    int maxAttempts = 8;
+    int ackDelayMs = 200;
+};
+
+// Optional at-least-once delivery for critical signaling messages.
+//
+// Critical messages get a "seq" metadata entry and are kept until the
+// peer acknowledges them; every outbound message piggybacks the latest
+// cumulative "ack". Unacknowledged messages are retransmitted from the
+// event loop's timer wheel with exponential backoff. If nothing outbound
+// carries an owed ack within ackDelay, a standalone ACK is sent.
+// Sending never waits for an acknowledgement.
+//
+// Sequence numbers belong to a connection: the peer tracks them per
+// connection, so startSession() restarts both directions at 1.
+class ReliableChannel {
+public:
+    typedef ReliableChannelOptions Options;
+
+    // Hands a serialized frame to the transport
+    typedef std::function<void(const std::string&)> Transmit;
+
+    ReliableChannel(TimerWheel& timers, Transmit transmit, const Options& options = Options());
+    ~ReliableChannel();
+
+    // Types that must survive a dropped connection
+    static bool isCritical(SignalingMessageType type);
+
+    // Stamp seq/ack onto an outbound message and serialize it
+    std::string prepareOutbound(SignalingMessage& message);
+    std::string prepareOutbound(PreparedMessage& message);
+
+    // Consume seq/ack of an inbound message; false if it is a duplicate
+    // that must not be delivered again
+    bool processInbound(const SignalingMessage& message);
+
+    // New connection: restart sequencing and resend everything still
+    // unacknowledged, renumbered from 1
+    void startSession();
+
+    size_t unackedCount() const;
+
+private:
+    struct PendingMessage {
+        std::string frame;
+        std::function<std::string(uint64_t)> restamp;   // Frame under a new seq
+        int attempts;
+        int rtoMs;
+        TimerWheel::TimerId timer;
+    };
+
+    TimerWheel& timers;
+    Transmit transmit;
+    Options options;
+
+    mutable std::mutex mutex;
+    uint64_t nextSeq;
+    std::map<uint64_t, PendingMessage> unacked;
+
+    ReceiveWindow receiveWindow;
+    bool ackOwed;
+    TimerWheel::TimerId ackTimer;
+
+    // Shared by both prepareOutbound() overloads
+    template <typename Message>
+    std::string stamp(Message& message);
+
+    void onRetransmitTimer(uint64_t seq);
+    void onAckTimer();
+    void handleAck(uint64_t ack);
+};
+
+#endif // RELIABLE_CHANNEL_H
\ No newline at end of file
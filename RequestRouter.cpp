@@ -0,0 +1,141 @@
+// src/RequestRouter.cpp
+#include "RequestRouter.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+// Constructor
+RequestRouter::RequestRouter(const char* defaultActionName)
+    : defaultAction(defaultActionName) {
+}
+
+// Registration
+void RequestRouter::addRoute(const char* action, uint32_t hash, unsigned int maxInFlight,
+    unsigned int maxPerSecond, Handler handler) {
+    if (hash != requestActionHash(action)) {
+        throw std::invalid_argument(std::string("Route hash mismatch for ") + action);
+    }
+
+    size_t index = hash & (kTableSize - 1);
+    for (size_t probes = 0; probes < kTableSize / 2; probes++) {
+        if (!table[index]) {
+            Route* route = new Route();
+            route->action = action;
+            route->hash = hash;
+            route->maxInFlight = maxInFlight;
+            route->maxPerSecond = maxPerSecond;
+            route->tokens = maxPerSecond;
+            route->refilled = std::chrono::steady_clock::now();
+            route->inFlight.store(0, std::memory_order_relaxed);
+            route->accepted.store(0, std::memory_order_relaxed);
+            route->rejected.store(0, std::memory_order_relaxed);
+            route->handler = handler;
+            table[index].reset(route);
+            return;
+        }
+        index = (index + 1) & (kTableSize - 1);
+    }
+
+    throw std::runtime_error("Request route table full");
+}
+
+RequestRouter::Route* RequestRouter::findRoute(const char* action, uint32_t hash) const {
+    size_t index = hash & (kTableSize - 1);
+    for (size_t probes = 0; probes < kTableSize && table[index]; probes++) {
+        Route* route = table[index].get();
+        if (route->hash == hash && route->action == action) {
+            return route;
+        }
+        index = (index + 1) & (kTableSize - 1);
+    }
+    return nullptr;
+}
+
+// Dispatch
+RequestRouter::Ticket RequestRouter::acquire(Route* route) {
+    unsigned int current = route->inFlight.load(std::memory_order_relaxed);
+    do {
+        if (current >= route->maxInFlight) {
+            return Ticket();
+        }
+    } while (!route->inFlight.compare_exchange_weak(current, current + 1,
+        std::memory_order_acq_rel));
+
+    // The deleter is the release; no allocation beyond the control block
+    return Ticket(route, [](const void* owner) {
+        static_cast<Route*>(const_cast<void*>(owner))->inFlight.fetch_sub(1, std::memory_order_acq_rel);
+    });
+}
+
+bool RequestRouter::takeToken(Route* route) {
+    if (route->maxPerSecond == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(route->rateMutex);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - route->refilled).count();
+    route->refilled = now;
+
+    // A full bucket allows one second's worth as a burst
+    route->tokens = std::min(static_cast<double>(route->maxPerSecond),
+        route->tokens + elapsed * route->maxPerSecond);
+    if (route->tokens < 1.0) {
+        return false;
+    }
+    route->tokens -= 1.0;
+    return true;
+}
+
+RequestRouter::Admission RequestRouter::dispatch(const SignalingMessage& message) {
+    std::string action = defaultAction;
+
+    cJSON* payload = message.getPayload();
+    cJSON* actionJson = cJSON_GetObjectItemCaseSensitive(payload, "action");
+    cJSON* typeJson = cJSON_GetObjectItemCaseSensitive(payload, "type");
+    if (cJSON_IsString(actionJson)) {
+        action = actionJson->valuestring;
+    }
+    else if (cJSON_IsString(typeJson) &&
+        findRoute(typeJson->valuestring, requestActionHash(typeJson->valuestring))) {
+        // Early snapshot clients sent {"type": "snapshot"}; any other
+        // "type" is a legacy request for the default action
+        action = typeJson->valuestring;
+    }
+    cJSON_Delete(payload);
+
+    Route* route = findRoute(action.c_str(), requestActionHash(action.c_str()));
+    if (!route) {
+        return Admission::UNKNOWN_ACTION;
+    }
+
+    Ticket ticket = acquire(route);
+    if (!ticket || !takeToken(route)) {
+        route->rejected.fetch_add(1, std::memory_order_relaxed);
+        return Admission::BUSY;
+    }
+
+    route->accepted.fetch_add(1, std::memory_order_relaxed);
+    route->handler(message, std::move(ticket));
+    return Admission::ACCEPTED;
+}
+
+cJSON* RequestRouter::toJson() const {
+    cJSON* report = cJSON_CreateObject();
+    for (size_t i = 0; i < kTableSize; i++) {
+        const Route* route = table[i].get();
+        if (!route) {
+            continue;
+        }
+
+        cJSON* stats = cJSON_AddObjectToObject(report, route->action.c_str());
+        cJSON_AddNumberToObject(stats, "in_flight", route->inFlight.load(std::memory_order_relaxed));
+        cJSON_AddNumberToObject(stats, "limit", route->maxInFlight);
+        cJSON_AddNumberToObject(stats, "per_second", route->maxPerSecond);
+        cJSON_AddNumberToObject(stats, "accepted",
+            static_cast<double>(route->accepted.load(std::memory_order_relaxed)));
+        cJSON_AddNumberToObject(stats, "rejected",
+            static_cast<double>(route->rejected.load(std::memory_order_relaxed)));
+    }
+    return report;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// include/RequestRouter.h
+#ifndef REQUEST_ROUTER_H
+#define REQUEST_ROUTER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+#include "SignalingProtocol.h"
+
+// FNV-1a over an action name; constexpr so route keys are fixed at
+// compile time and only the incoming action is hashed at runtime
+constexpr uint32_t requestActionHash(const char* action) {
+    uint32_t hash = 2166136261u;
+    while (*action) {
+        hash = (hash ^ static_cast<uint8_t>(*action++)) * 16777619u;
+    }
+    return hash;
+}
+
+// Table-driven dispatch of REQUEST messages on payload "action".
+//
+// Each action has its own in-flight limit. A request is admitted only
+// if its action has a free slot, so a burst of one kind (say, snapshot
+// polls) is refused with "busy" instead of queueing ahead of others.
+// The handler receives a ticket holding the slot; the slot is freed
+// when the last copy of the ticket is dropped, which lets asynchronous
+// handlers keep it until their reply has gone out, and long-lived work
+// (a stream session) keep it until it ends. Handlers that answer before
+// returning never hold a slot for long, so their routes are bounded by
+// a rate instead: a token bucket refilled at maxPerSecond.
+class RequestRouter {
+public:
+    typedef std::shared_ptr<const void> Ticket;
+    typedef std::function<void(const SignalingMessage&, Ticket)> Handler;
+
+    enum class Admission {
+        ACCEPTED,
+        UNKNOWN_ACTION,
+        BUSY
+    };
+
+    // Action used when a REQUEST carries none
+    explicit RequestRouter(const char* defaultAction);
+
+    // Registration, before the first dispatch; maxPerSecond 0 = no rate limit
+    void addRoute(const char* action, uint32_t hash, unsigned int maxInFlight,
+        unsigned int maxPerSecond, Handler handler);
+
+    Admission dispatch(const SignalingMessage& message);
+
+    // {"stream": {"in_flight": n, "limit": n, "per_second": n, "accepted": n,
+    //  "rejected": n}, ...}
+    cJSON* toJson() const;
+
+private:
+    static const size_t kTableSize = 16;    // Power of two, at most half full
+
+    struct Route {
+        std::string action;
+        uint32_t hash;
+        unsigned int maxInFlight;
+        unsigned int maxPerSecond;
+        std::atomic<unsigned int> inFlight;
+        std::atomic<uint64_t> accepted;
+        std::atomic<uint64_t> rejected;
+        Handler handler;
+
+        std::mutex rateMutex;
+        double tokens;
+        std::chrono::steady_clock::time_point refilled;
+    };
+
+    std::unique_ptr<Route> table[kTableSize];
+    std::string defaultAction;
+
+    Route* findRoute(const char* action, uint32_t hash) const;
+    static Ticket acquire(Route* route);
+    static bool takeToken(Route* route);
+};
+
+#endif // REQUEST_ROUTER_H
\ No newline at end of file
@@ -0,0 +1,164 @@
+// include/RtpPacket.h
+#ifndef RTP_PACKET_H
+#define RTP_PACKET_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Big-endian field access for RTP/RTCP headers
+inline uint16_t rtpReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t rtpReadU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline void rtpWriteU16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+inline void rtpWriteU32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+// Parsed view of one RTP packet; does not own the buffer.
+//
+// Layer information comes from the frame marking header extension
+// (one-byte form) when the sender negotiated one: I = independent
+// (keyframe), B = base layer sync (a temporal switch-up point), TID =
+// temporal layer. Without it, keyframes are found in the H.264 payload
+// and everything is temporal layer 0.
+struct RtpPacketView {
+    static const size_t kFixedHeaderSize = 12;
+
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    size_t headerLength = 0;            // Fixed header, CSRCs and extension
+
+    bool marker = false;
+    uint8_t payloadType = 0;
+    uint16_t seq = 0;
+    uint32_t timestamp = 0;
+    uint32_t ssrc = 0;
+
+    bool hasFrameMarking = false;
+    uint8_t frameMarking = 0;
+
+    // RTCP shares the port under rtcp-mux; packet types 200-204 land in
+    // the marker/payload-type byte
+    static bool isRtcp(const uint8_t* packet, size_t size) {
+        return size >= 2 && packet[1] >= 200 && packet[1] <= 204;
+    }
+
+    // frameMarkingId is the negotiated extension id, 0 if none
+    bool parse(const uint8_t* packet, size_t size, int frameMarkingId) {
+        if (size < kFixedHeaderSize || (packet[0] >> 6) != 2 || isRtcp(packet, size)) {
+            return false;
+        }
+
+        data = packet;
+        length = size;
+        marker = (packet[1] & 0x80) != 0;
+        payloadType = packet[1] & 0x7F;
+        seq = rtpReadU16(packet + 2);
+        timestamp = rtpReadU32(packet + 4);
+        ssrc = rtpReadU32(packet + 8);
+        hasFrameMarking = false;
+
+        size_t offset = kFixedHeaderSize + 4 * (packet[0] & 0x0F);
+        if (packet[0] & 0x10) {
+            if (offset + 4 > size) {
+                return false;
+            }
+            uint16_t profile = rtpReadU16(packet + offset);
+            size_t extensionEnd = offset + 4 + 4 * rtpReadU16(packet + offset + 2);
+            if (extensionEnd > size) {
+                return false;
+            }
+            if (profile == 0xBEDE && frameMarkingId > 0) {
+                findFrameMarking(packet + offset + 4, packet + extensionEnd, frameMarkingId);
+            }
+            offset = extensionEnd;
+        }
+
+        if (offset > size) {
+            return false;
+        }
+        headerLength = offset;
+        return true;
+    }
+
+    const uint8_t* payload() const { return data + headerLength; }
+    size_t payloadLength() const { return length - headerLength; }
+
+    uint8_t temporalId() const { return hasFrameMarking ? (frameMarking & 0x07) : 0; }
+    bool frameStart() const { return hasFrameMarking && (frameMarking & 0x80) != 0; }
+
+    bool keyframe() const {
+        return hasFrameMarking ? (frameMarking & 0x20) != 0 : h264Keyframe();
+    }
+
+    // Temporal layers above 0 may be added from here on
+    bool switchPoint() const {
+        return hasFrameMarking ? (frameMarking & 0x28) != 0 : h264Keyframe();
+    }
+
+    // IDR or SPS, single NAL, STAP-A or the first FU-A fragment
+    bool h264Keyframe() const {
+        const uint8_t* p = payload();
+        size_t n = payloadLength();
+        if (n < 1) {
+            return false;
+        }
+
+        uint8_t type = p[0] & 0x1F;
+        if (type == 5 || type == 7) {
+            return true;
+        }
+        if (type == 24) {
+            for (size_t i = 1; i + 2 < n;) {
+                size_t nalSize = rtpReadU16(p + i);
+                uint8_t nalType = p[i + 2] & 0x1F;
+                if (nalType == 5 || nalType == 7) {
+                    return true;
+                }
+                i += 2 + nalSize;
+            }
+            return false;
+        }
+        if (type == 28 && n >= 2) {
+            return (p[1] & 0x80) && ((p[1] & 0x1F) == 5 || (p[1] & 0x1F) == 7);
+        }
+        return false;
+    }
+
+private:
+    void findFrameMarking(const uint8_t* p, const uint8_t* end, int id) {
+        while (p < end) {
+            uint8_t element = *p;
+            if (element == 0) {             // Padding
+                p++;
+                continue;
+            }
+            int elementId = element >> 4;
+            size_t elementLength = (element & 0x0F) + 1;
+            if (elementId == 15 || p + 1 + elementLength > end) {
+                return;
+            }
+            if (elementId == id) {
+                hasFrameMarking = true;
+                frameMarking = p[1];
+                return;
+            }
+            p += 1 + elementLength;
+        }
+    }
+};
+
+#endif // RTP_PACKET_H
\ No newline at end of file
@@ -0,0 +1,787 @@
+// src/RtpRelay.cpp
+#include "RtpRelay.h"
+#include "Logger.h"
+#include "MemoryAccounting.h"
+#include "Watchdog.h"
+#include <algorithm>
+#include <random>
+#include <new>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+
+namespace {
+    const size_t kMaxShards = 8;        // Each shard holds a watchdog slot
+    const int kPollMs = 200;
+    const int kReceiveBuffer = 1 << 20;
+
+    // Gap inserted into the timestamp when a source restarts or a viewer
+    // changes layer: one frame at 30 fps on the 90 kHz video clock
+    const uint32_t kRestartTimestampGap = 3000;
+
+    // Bitrate shares of the temporal layers in a typical three-layer
+    // stream: TL0 about half, TL0+TL1 about three quarters
+    const double kBaseLayerShare = 0.5;
+    const double kTwoLayerShare = 0.75;
+
+    // Batches drained per wake-up before other sources get a turn
+    const int kBatchesPerWake = 4;
+
+    // Weight of the newest receiver report in a viewer's loss estimate
+    const double kLossSmoothing = 0.3;
+
+    const uint8_t kRtcpSenderReport = 200;
+    const uint8_t kRtcpReceiverReport = 201;
+
+    bool sameEndpoint(const sockaddr_storage& a, const sockaddr_storage& b) {
+        if (a.ss_family != AF_INET || b.ss_family != AF_INET) {
+            return false;
+        }
+        const sockaddr_in& x = reinterpret_cast<const sockaddr_in&>(a);
+        const sockaddr_in& y = reinterpret_cast<const sockaddr_in&>(b);
+        return x.sin_addr.s_addr == y.sin_addr.s_addr && x.sin_port == y.sin_port;
+    }
+
+    uint32_t randomSsrc() {
+        static std::mt19937 generator{ std::random_device{}() };
+        static std::mutex generatorMutex;
+        std::lock_guard<std::mutex> lock(generatorMutex);
+        uint32_t ssrc;
+        do {
+            ssrc = generator();
+        } while (ssrc == 0);
+        return ssrc;
+    }
+}
+
+bool RelayEndpoint::resolve(const std::string& host, uint16_t port, RelayEndpoint& endpoint) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (port == 0 || inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        return false;
+    }
+
+    memset(&endpoint.address, 0, sizeof(endpoint.address));
+    memcpy(&endpoint.address, &address, sizeof(address));
+    endpoint.length = sizeof(address);
+    return true;
+}
+
+// Constructor and Destructor
+RtpRelay::RtpRelay(const DeviceConfig::RelaySettings& relaySettings)
+    : settings(relaySettings),
+    running(false),
+    nextPort(relaySettings.portBase),
+    nextShard(0) {
+
+    size_t count = settings.shards > 0 ? settings.shards : std::thread::hardware_concurrency();
+    count = std::max<size_t>(1, std::min(count, kMaxShards));
+
+    for (size_t i = 0; i < count; i++) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        shard->sendFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (shard->epollFd < 0 || shard->sendFd < 0) {
+            throw std::runtime_error("Relay shard setup failed");
+        }
+
+        shard->buffers = static_cast<uint8_t*>(
+            MemoryAccounting::allocate(MemoryTag::PACKETS, kBatch * kMaxPacket));
+        if (!shard->buffers) {
+            throw std::bad_alloc();
+        }
+        shard->sendMessages.resize(kSendBatch);
+        shard->sendVectors.resize(kSendBatch * 2);
+        shard->sendHeaders.resize(kSendBatch * RtpPacketView::kFixedHeaderSize);
+        if (settings.fec) {
+            shard->fecBuffers = static_cast<uint8_t*>(
+                MemoryAccounting::allocate(MemoryTag::PACKETS, kFecSlots * FecEncoder::kMaxPacket));
+            if (!shard->fecBuffers) {
+                throw std::bad_alloc();
+            }
+        }
+
+        // Viewers' RTCP comes back to the socket we send from
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = shard->sendFd;
+        epoll_ctl(shard->epollFd, EPOLL_CTL_ADD, shard->sendFd, &event);
+        shards.push_back(std::move(shard));
+    }
+}
+
+RtpRelay::~RtpRelay() {
+    stop();
+
+    for (auto& shard : shards) {
+        for (auto& entry : shard->sources) {
+            close(entry.first);
+        }
+        close(shard->epollFd);
+        close(shard->sendFd);
+        MemoryAccounting::deallocate(shard->buffers);
+        if (shard->fecBuffers) {
+            MemoryAccounting::deallocate(shard->fecBuffers);
+        }
+    }
+}
+
+// Shard Threads
+void RtpRelay::start(const ThreadPolicy& policy) {
+    if (running.exchange(true)) {
+        return;
+    }
+
+    for (size_t i = 0; i < shards.size(); i++) {
+        ThreadPolicy shardPolicy = policy;
+        shardPolicy.name = policy.name + "-" + std::to_string(i);
+        unsigned int cpus = std::thread::hardware_concurrency();
+        if (shardPolicy.cpus.empty() && cpus > 0) {
+            shardPolicy.cpus.push_back(static_cast<int>(i % cpus));
+        }
+        shards[i]->thread = std::thread(&RtpRelay::runShard, this, shards[i].get(), shardPolicy);
+    }
+}
+
+void RtpRelay::stop() {
+    running = false;
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+void RtpRelay::runShard(Shard* shard, ThreadPolicy policy) {
+    policy.apply();
+    WatchdogLease watchdog(policy.name.c_str());
+
+    epoll_event events[16];
+    while (running.load(std::memory_order_relaxed)) {
+        watchdog.kick();
+
+        int ready = epoll_wait(shard->epollFd, events, 16, kPollMs);
+        if (ready <= 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.fd == shard->sendFd) {
+                receiveFeedback(shard);
+                continue;
+            }
+
+            // Looked up by socket: the source may have been removed since
+            auto found = shard->sources.find(events[i].data.fd);
+            if (found != shard->sources.end()) {
+                receive(shard, found->second.get());
+            }
+        }
+    }
+}
+
+// Forwarding
+void RtpRelay::receive(Shard* shard, Source* source) {
+    mmsghdr messages[kBatch];
+    iovec vectors[kBatch];
+    RtpPacketView packets[kBatch];
+    int layers[kBatch];
+
+    for (int round = 0; round < kBatchesPerWake; round++) {
+        memset(messages, 0, sizeof(messages));
+        for (size_t i = 0; i < kBatch; i++) {
+            vectors[i].iov_base = shard->buffers + i * kMaxPacket;
+            vectors[i].iov_len = kMaxPacket;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int received = recvmmsg(source->fd, messages, kBatch, MSG_DONTWAIT, nullptr);
+        if (received <= 0) {
+            return;
+        }
+        shard->packetsIn.fetch_add(received, std::memory_order_relaxed);
+
+        // Keep the forwardable ones
+        size_t count = 0;
+        for (int i = 0; i < received; i++) {
+            const uint8_t* data = static_cast<const uint8_t*>(vectors[i].iov_base);
+            RtpPacketView& packet = packets[count];
+            if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) ||
+                !packet.parse(data, messages[i].msg_len, source->frameMarkingId) ||
+                !normalize(source, packet) ||
+                (layers[count] = layerOf(source, packet)) < 0) {
+                shard->dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            count++;
+        }
+        source->packets += count;
+
+        if (count > 0 && !source->viewers.empty()) {
+            fanOut(shard, source, packets, layers, count);
+        }
+
+        if (static_cast<size_t>(received) < kBatch) {
+            return;
+        }
+    }
+}
+
+bool RtpRelay::normalize(Source* source, RtpPacketView& packet) {
+    // Declared layers keep their own numbering; each viewer maps it
+    if (!source->layers.empty()) {
+        return true;
+    }
+
+    bool first = !source->seen;
+    if (first || packet.ssrc != source->inSsrc) {
+        // New or restarted sender: continue where the viewers left off
+        if (!first) {
+            LOG_INFO("Relay: source %s restarted (ssrc %08x -> %08x)", source->id, source->inSsrc, packet.ssrc);
+            source->seqOffset = static_cast<uint16_t>(source->lastSeq + 1 - packet.seq);
+            source->timestampOffset = source->lastTimestamp + kRestartTimestampGap - packet.timestamp;
+        }
+        source->inSsrc = packet.ssrc;
+        source->seen = true;
+    }
+
+    packet.seq = static_cast<uint16_t>(packet.seq + source->seqOffset);
+    packet.timestamp += source->timestampOffset;
+
+    // Track the newest packet; reordered ones must not move us backwards
+    if (first || static_cast<int16_t>(packet.seq - source->lastSeq) > 0) {
+        source->lastSeq = packet.seq;
+        source->lastTimestamp = packet.timestamp;
+    }
+    return true;
+}
+
+int RtpRelay::layerOf(const Source* source, const RtpPacketView& packet) const {
+    if (source->layers.empty()) {
+        return 0;
+    }
+    for (size_t i = 0; i < source->layers.size(); i++) {
+        if (source->layers[i].ssrc == packet.ssrc) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool RtpRelay::select(const Source* source, Viewer& viewer, int layer, const RtpPacketView& packet,
+    uint8_t* header) {
+    if (layer != viewer.layer) {
+        // Start, or change simulcast layer, only at the first packet of a
+        // keyframe of the target; frame marking flags every packet of it
+        if (layer != viewer.targetLayer || !packet.keyframe() ||
+            (packet.hasFrameMarking && !packet.frameStart())) {
+            return false;
+        }
+
+        // Continue the viewer's own numbering across the change
+        if (viewer.forwarded) {
+            viewer.seqDelta = static_cast<uint16_t>(viewer.lastSeq + 1 - packet.seq);
+            viewer.timestampDelta = viewer.lastTimestamp + kRestartTimestampGap - packet.timestamp;
+        }
+        viewer.layer = layer;
+        viewer.temporal = viewer.targetTemporal;
+        viewer.lastInTimestamp = packet.timestamp;
+    }
+    else if (packet.frameStart() || packet.timestamp != viewer.lastInTimestamp) {
+        // Temporal layers: drop at any frame, add only at a switch-up point
+        if (viewer.targetTemporal < viewer.temporal) {
+            viewer.temporal = viewer.targetTemporal;
+        }
+        else if (viewer.targetTemporal > viewer.temporal && packet.switchPoint()) {
+            viewer.temporal = viewer.targetTemporal;
+        }
+        viewer.lastInTimestamp = packet.timestamp;
+    }
+
+    if (packet.temporalId() > viewer.temporal) {
+        // Close the gap so the viewer does not NACK what was never sent
+        viewer.seqDelta--;
+        return false;
+    }
+
+    uint16_t seq = static_cast<uint16_t>(packet.seq + viewer.seqDelta);
+    uint32_t timestamp = packet.timestamp + viewer.timestampDelta;
+    if (!viewer.forwarded || static_cast<int16_t>(seq - viewer.lastSeq) > 0) {
+        viewer.lastSeq = seq;
+        viewer.lastTimestamp = timestamp;
+    }
+    viewer.forwarded = true;
+
+    memcpy(header, packet.data, RtpPacketView::kFixedHeaderSize);
+    rtpWriteU16(header + 2, seq);
+    rtpWriteU32(header + 4, timestamp);
+    rtpWriteU32(header + 8, source->outSsrc);
+    return true;
+}
+
+void RtpRelay::retarget(const Source* source, Viewer& viewer) {
+    uint8_t temporal = viewer.maxTemporal < 0 ? kAllTemporal :
+        static_cast<uint8_t>(std::min<int>(viewer.maxTemporal, kAllTemporal));
+
+    viewer.targetLayer = 0;
+    if (!source->layers.empty()) {
+        // Highest layer within the budget, else the lowest
+        for (size_t i = 0; i < source->layers.size(); i++) {
+            if (viewer.maxKbps <= 0 || source->layers[i].kbps <= viewer.maxKbps) {
+                viewer.targetLayer = static_cast<int>(i);
+            }
+        }
+
+        // Still over budget on the lowest layer: shed temporal layers
+        int layerKbps = source->layers[viewer.targetLayer].kbps;
+        if (viewer.maxKbps > 0 && layerKbps > viewer.maxKbps) {
+            double share = static_cast<double>(viewer.maxKbps) / layerKbps;
+            if (share < kBaseLayerShare) {
+                temporal = 0;
+            }
+            else if (share < kTwoLayerShare) {
+                temporal = std::min<uint8_t>(temporal, 1);
+            }
+        }
+    }
+    viewer.targetTemporal = temporal;
+}
+
+void RtpRelay::fanOut(Shard* shard, Source* source, const RtpPacketView* packets, const int* layers,
+    size_t count) {
+    size_t pending = 0;
+    auto flush = [&]() {
+        size_t offset = 0;
+        while (offset < pending) {
+            int sent = sendmmsg(shard->sendFd, &shard->sendMessages[offset],
+                static_cast<unsigned int>(pending - offset), MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // Socket buffer full: late media is worthless, drop it
+                shard->dropped.fetch_add(pending - offset, std::memory_order_relaxed);
+                break;
+            }
+            shard->packetsOut.fetch_add(sent, std::memory_order_relaxed);
+            offset += sent;
+        }
+        pending = 0;
+        shard->fecUsed = 0;
+    };
+
+    // Only the fixed header is per viewer; the rest points into the
+    // receive buffer
+    for (size_t p = 0; p < count; p++) {
+        const RtpPacketView& packet = packets[p];
+        for (Viewer& viewer : source->viewers) {
+            uint8_t* header = &shard->sendHeaders[pending * RtpPacketView::kFixedHeaderSize];
+            if (!select(source, viewer, layers[p], packet, header)) {
+                continue;
+            }
+
+            iovec* vectors = &shard->sendVectors[pending * 2];
+            vectors[0].iov_base = header;
+            vectors[0].iov_len = RtpPacketView::kFixedHeaderSize;
+            vectors[1].iov_base = const_cast<uint8_t*>(packet.data + RtpPacketView::kFixedHeaderSize);
+            vectors[1].iov_len = packet.length - RtpPacketView::kFixedHeaderSize;
+
+            msghdr& message = shard->sendMessages[pending].msg_hdr;
+            memset(&message, 0, sizeof(message));
+            message.msg_name = &viewer.endpoint.address;
+            message.msg_namelen = viewer.endpoint.length;
+            message.msg_iov = vectors;
+            message.msg_iovlen = 2;
+
+            if (++pending == kSendBatch) {
+                flush();
+            }
+
+            if (!viewer.fec) {
+                continue;
+            }
+
+            // The header slot is only reused after this, so it is intact
+            // even if the batch was just flushed
+            if (shard->fecUsed == kFecSlots) {
+                flush();
+            }
+            uint8_t* repair = shard->fecBuffers + shard->fecUsed * FecEncoder::kMaxPacket;
+            size_t repairLength = viewer.fec->protect(header,
+                packet.data + RtpPacketView::kFixedHeaderSize,
+                packet.length - RtpPacketView::kFixedHeaderSize, repair);
+            if (repairLength == 0) {
+                continue;
+            }
+            shard->fecUsed++;
+            shard->fecOut.fetch_add(1, std::memory_order_relaxed);
+
+            iovec* repairVector = &shard->sendVectors[pending * 2];
+            repairVector->iov_base = repair;
+            repairVector->iov_len = repairLength;
+
+            msghdr& repairMessage = shard->sendMessages[pending].msg_hdr;
+            memset(&repairMessage, 0, sizeof(repairMessage));
+            repairMessage.msg_name = &viewer.endpoint.address;
+            repairMessage.msg_namelen = viewer.endpoint.length;
+            repairMessage.msg_iov = repairVector;
+            repairMessage.msg_iovlen = 1;
+
+            if (++pending == kSendBatch) {
+                flush();
+            }
+        }
+    }
+    flush();
+}
+
+// Receiver Reports
+void RtpRelay::receiveFeedback(Shard* shard) {
+    uint8_t buffer[1500];
+    sockaddr_storage from;
+
+    while (true) {
+        socklen_t fromLength = sizeof(from);
+        ssize_t received = recvfrom(shard->sendFd, buffer, sizeof(buffer), MSG_DONTWAIT,
+            reinterpret_cast<sockaddr*>(&from), &fromLength);
+        if (received <= 0) {
+            return;
+        }
+
+        // Walk the compound packet for report blocks
+        size_t offset = 0;
+        size_t size = static_cast<size_t>(received);
+        while (offset + 8 <= size) {
+            const uint8_t* rtcp = buffer + offset;
+            size_t length = 4 * (static_cast<size_t>(rtpReadU16(rtcp + 2)) + 1);
+            if ((rtcp[0] >> 6) != 2 || offset + length > size) {
+                break;
+            }
+
+            size_t blocks = rtcp[0] & 0x1F;
+            size_t first = rtcp[1] == kRtcpReceiverReport ? 8 :
+                (rtcp[1] == kRtcpSenderReport ? 28 : length);
+            for (size_t i = 0; i < blocks && first + 24 * (i + 1) <= length; i++) {
+                const uint8_t* block = rtcp + first + 24 * i;
+                applyReport(shard, from, rtpReadU32(block), block[4]);
+            }
+            offset += length;
+        }
+    }
+}
+
+void RtpRelay::applyReport(Shard* shard, const sockaddr_storage& from, uint32_t ssrc,
+    uint8_t fractionLost) {
+    for (auto& entry : shard->sources) {
+        Source* source = entry.second.get();
+        if (source->outSsrc != ssrc) {
+            continue;
+        }
+
+        for (Viewer& viewer : source->viewers) {
+            if (!sameEndpoint(viewer.endpoint.address, from)) {
+                continue;
+            }
+            viewer.loss += kLossSmoothing * (fractionLost / 256.0 - viewer.loss);
+            if (viewer.fec) {
+                viewer.fec->setGroupSize(FecEncoder::groupSizeForLoss(viewer.loss));
+            }
+            return;
+        }
+    }
+}
+
+// Sources
+int RtpRelay::openPort(uint16_t& port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &kReceiveBuffer, sizeof(kReceiveBuffer));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    if (inet_pton(AF_INET, settings.bindAddress.c_str(), &address.sin_addr) != 1) {
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+    }
+
+    // Walk the range from where the last allocation stopped
+    for (int attempt = 0; attempt < settings.portCount; attempt++) {
+        uint16_t candidate = nextPort;
+        nextPort = static_cast<uint16_t>(nextPort + 1);
+        if (nextPort >= settings.portBase + settings.portCount) {
+            nextPort = static_cast<uint16_t>(settings.portBase);
+        }
+
+        address.sin_port = htons(candidate);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            port = candidate;
+            return fd;
+        }
+    }
+
+    close(fd);
+    return -1;
+}
+
+uint16_t RtpRelay::addSource(const std::string& sourceId) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto existing = sourceIndex.find(sourceId);
+    if (existing != sourceIndex.end()) {
+        Shard* shard = existing->second.first;
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        return shard->sources[existing->second.second]->port;
+    }
+
+    uint16_t port = 0;
+    int fd = openPort(port);
+    if (fd < 0) {
+        LOG_WARN("Relay: no free port for source %s", sourceId);
+        return 0;
+    }
+
+    std::unique_ptr<Source> source(new Source());
+    source->id = sourceId;
+    source->fd = fd;
+    source->port = port;
+    source->outSsrc = randomSsrc();
+    source->fecSsrc = settings.fec ? randomSsrc() : 0;
+
+    Shard* shard = shards[nextShard++ % shards.size()].get();
+    {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(shard->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            return 0;
+        }
+        shard->sources[fd] = std::move(source);
+    }
+
+    sourceIndex[sourceId] = std::make_pair(shard, fd);
+    LOG_INFO("Relay: source %s on port %u", sourceId, port);
+    return port;
+}
+
+std::vector<std::string> RtpRelay::removeSource(const std::string& sourceId) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    std::vector<std::string> detached;
+    auto found = sourceIndex.find(sourceId);
+    if (found == sourceIndex.end()) {
+        return detached;
+    }
+
+    Shard* shard = found->second.first;
+    int fd = found->second.second;
+    {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        auto entry = shard->sources.find(fd);
+        for (const Viewer& viewer : entry->second->viewers) {
+            viewerIndex.erase(viewer.id);
+            detached.push_back(viewer.id);
+        }
+        epoll_ctl(shard->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        shard->sources.erase(entry);
+    }
+
+    sourceIndex.erase(found);
+    LOG_INFO("Relay: source %s closed", sourceId);
+    return detached;
+}
+
+void RtpRelay::setSourceLayers(const std::string& sourceId, const std::vector<RelayLayer>& layers,
+    int frameMarkingId) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto found = sourceIndex.find(sourceId);
+    if (found == sourceIndex.end()) {
+        return;
+    }
+
+    Shard* shard = found->second.first;
+    std::lock_guard<std::mutex> shardLock(shard->mutex);
+    Source* source = shard->sources[found->second.second].get();
+    source->layers = layers;
+    source->frameMarkingId = frameMarkingId;
+
+    // Numbering spaces changed: every viewer restarts on a keyframe
+    for (Viewer& viewer : source->viewers) {
+        viewer.layer = -1;
+        retarget(source, viewer);
+    }
+}
+
+uint32_t RtpRelay::fecSsrc(const std::string& sourceId) const {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto found = sourceIndex.find(sourceId);
+    if (found == sourceIndex.end()) {
+        return 0;
+    }
+    Shard* shard = found->second.first;
+    std::lock_guard<std::mutex> shardLock(shard->mutex);
+    return shard->sources[found->second.second]->fecSsrc;
+}
+
+bool RtpRelay::hasSource(const std::string& sourceId) const {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    return sourceIndex.count(sourceId) != 0;
+}
+
+// Viewers
+uint32_t RtpRelay::addViewer(const std::string& sourceId, const std::string& viewerId,
+    const RelayEndpoint& endpoint, std::string& previousSource, size_t& remaining) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    previousSource.clear();
+    remaining = 0;
+
+    auto found = sourceIndex.find(sourceId);
+    if (found == sourceIndex.end()) {
+        return 0;
+    }
+
+    uint32_t ssrc;
+    {
+        Shard* shard = found->second.first;
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        Source* source = shard->sources[found->second.second].get();
+
+        auto viewer = std::find_if(source->viewers.begin(), source->viewers.end(),
+            [&](const Viewer& entry) { return entry.id == viewerId; });
+        if (viewer != source->viewers.end()) {
+            viewer->endpoint = endpoint;
+        }
+        else {
+            // A full source leaves the viewer where it was
+            if (source->viewers.size() >= static_cast<size_t>(settings.maxViewersPerSource)) {
+                return 0;
+            }
+            Viewer added;
+            added.id = viewerId;
+            added.endpoint = endpoint;
+            retarget(source, added);
+            if (source->fecSsrc != 0) {
+                added.fec.reset(new FecEncoder(source->outSsrc, source->fecSsrc,
+                    static_cast<uint8_t>(settings.fecPayloadType)));
+            }
+            source->viewers.push_back(std::move(added));
+        }
+        ssrc = source->outSsrc;
+    }
+
+    // A viewer watches one source at a time through the relay
+    auto previous = viewerIndex.find(viewerId);
+    if (previous != viewerIndex.end() && previous->second != sourceId) {
+        previousSource = previous->second;
+        auto old = sourceIndex.find(previousSource);
+        if (old != sourceIndex.end()) {
+            std::lock_guard<std::mutex> shardLock(old->second.first->mutex);
+            std::vector<Viewer>& viewers = old->second.first->sources[old->second.second]->viewers;
+            viewers.erase(std::remove_if(viewers.begin(), viewers.end(),
+                [&](const Viewer& viewer) { return viewer.id == viewerId; }), viewers.end());
+            remaining = viewers.size();
+        }
+    }
+
+    viewerIndex[viewerId] = sourceId;
+    return ssrc;
+}
+
+void RtpRelay::setViewerLimits(const std::string& viewerId, int maxKbps, int maxTemporal) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto found = viewerIndex.find(viewerId);
+    if (found == viewerIndex.end()) {
+        return;
+    }
+    auto source = sourceIndex.find(found->second);
+    if (source == sourceIndex.end()) {
+        return;
+    }
+
+    // Takes effect at the next keyframe or switch point
+    std::lock_guard<std::mutex> shardLock(source->second.first->mutex);
+    Source* entry = source->second.first->sources[source->second.second].get();
+    for (Viewer& viewer : entry->viewers) {
+        if (viewer.id == viewerId) {
+            viewer.maxKbps = maxKbps;
+            viewer.maxTemporal = maxTemporal;
+            retarget(entry, viewer);
+        }
+    }
+}
+
+bool RtpRelay::removeViewer(const std::string& viewerId, std::string& sourceId, size_t& remaining) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto found = viewerIndex.find(viewerId);
+    if (found == viewerIndex.end()) {
+        return false;
+    }
+    sourceId = found->second;
+    viewerIndex.erase(found);
+
+    auto source = sourceIndex.find(sourceId);
+    if (source == sourceIndex.end()) {
+        remaining = 0;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> shardLock(source->second.first->mutex);
+    std::vector<Viewer>& viewers = source->second.first->sources[source->second.second]->viewers;
+    viewers.erase(std::remove_if(viewers.begin(), viewers.end(),
+        [&](const Viewer& viewer) { return viewer.id == viewerId; }), viewers.end());
+    remaining = viewers.size();
+    return true;
+}
+
+cJSON* RtpRelay::toJson() const {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    uint64_t packetsIn = 0, packetsOut = 0, dropped = 0, fecOut = 0;
+    cJSON* json = cJSON_CreateObject();
+    cJSON* sources = cJSON_CreateArray();
+
+    for (const auto& shard : shards) {
+        packetsIn += shard->packetsIn.load(std::memory_order_relaxed);
+        packetsOut += shard->packetsOut.load(std::memory_order_relaxed);
+        dropped += shard->dropped.load(std::memory_order_relaxed);
+        fecOut += shard->fecOut.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        for (const auto& entry : shard->sources) {
+            const Source& source = *entry.second;
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "id", source.id.c_str());
+            cJSON_AddNumberToObject(item, "port", source.port);
+            cJSON_AddNumberToObject(item, "viewers", static_cast<double>(source.viewers.size()));
+            cJSON_AddNumberToObject(item, "layers", static_cast<double>(std::max<size_t>(1, source.layers.size())));
+            cJSON_AddNumberToObject(item, "packets", static_cast<double>(source.packets));
+            cJSON_AddItemToArray(sources, item);
+        }
+    }
+
+    cJSON_AddNumberToObject(json, "shards", static_cast<double>(shards.size()));
+    cJSON_AddNumberToObject(json, "packets_in", static_cast<double>(packetsIn));
+    cJSON_AddNumberToObject(json, "packets_out", static_cast<double>(packetsOut));
+    cJSON_AddNumberToObject(json, "dropped", static_cast<double>(dropped));
+    cJSON_AddNumberToObject(json, "fec_packets", static_cast<double>(fecOut));
+    cJSON_AddItemToObject(json, "sources", sources);
+    return json;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+// include/RtpRelay.h
+#ifndef RTP_RELAY_H
+#define RTP_RELAY_H
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <sys/socket.h>
+#include <cjson/cJSON.h>
+
+#include "DeviceConfig.h"
+#include "ThreadPolicy.h"
+#include "RtpPacket.h"
+#include "FecEncoder.h"
+
+// UDP destination of one viewer
+struct RelayEndpoint {
+    sockaddr_storage address;
+    socklen_t length = 0;
+
+    // Numeric IPv4 address; false if it does not parse
+    static bool resolve(const std::string& host, uint16_t port, RelayEndpoint& endpoint);
+};
+
+// One simulcast encoding of a source
+struct RelayLayer {
+    uint32_t ssrc = 0;
+    int kbps = 0;
+};
+
+// Packet forwarder for gateway relay mode.
+//
+// Each camera (source) sends RTP to its own UDP port on the gateway; the
+// relay forwards every packet to all viewers of that source without
+// touching the payload. Only the header is rewritten: the SSRC becomes a
+// relay-chosen one and sequence numbers and timestamps are offset, so a
+// camera restart (new SSRC, new sequence) looks like a continuous stream
+// to viewers.
+//
+// Sources are spread over shards, one thread per CPU. A shard receives
+// with recvmmsg and hands each packet to the kernel once per viewer
+// through a single sendmmsg call; the payload is never copied, so
+// fan-out costs one syscall per batch rather than a copy per viewer.
+// Control calls (add/remove) take the owning shard's lock briefly; the
+// shard holds it only while it processes a batch.
+//
+// Sources may send simulcast layers (one SSRC each) and temporal layers
+// (frame marking extension), and each viewer gets the layers that fit its
+// limits. Switching to another simulcast layer waits for that layer's
+// next keyframe, and adding temporal layers waits for a switch-up point,
+// so no viewer ever makes the encoder send a keyframe (PLI). Dropping
+// packets leaves holes in the sequence, so every viewer has its own
+// sequence and timestamp mapping: the fixed 12-byte header is built per
+// viewer and sent alongside the shared remainder of the packet.
+//
+// With FEC enabled each viewer also gets FlexFEC repair packets on a
+// separate SSRC. Viewers' RTCP receiver reports arrive on the shard's
+// send socket; the loss they report sets that viewer's protection.
+class RtpRelay {
+public:
+    explicit RtpRelay(const DeviceConfig::RelaySettings& settings);
+    ~RtpRelay();
+
+    // Shard threads; shard i is named "<policy.name>-i" and, unless the
+    // policy pins CPUs itself, runs on CPU i (modulo the CPU count)
+    void start(const ThreadPolicy& policy);
+    void stop();
+
+    // Local port the source should send to; 0 when no port is free.
+    // Adding an existing source returns its port.
+    uint16_t addSource(const std::string& sourceId);
+
+    // Simulcast layers, lowest first, and the frame marking extension id
+    // (0 if none). A source without layers is one layer of any SSRC.
+    void setSourceLayers(const std::string& sourceId, const std::vector<RelayLayer>& layers,
+        int frameMarkingId);
+
+    // Close a source; returns the viewers that were detached from it
+    std::vector<std::string> removeSource(const std::string& sourceId);
+
+    // Attach a viewer (or move it to a new endpoint). Returns the SSRC the
+    // viewer will see, or 0 when the source is unknown or full. A viewer
+    // that was watching another source is detached from it; that source
+    // and its remaining viewer count are reported, as by removeViewer(),
+    // with previousSource left empty when there was none.
+    uint32_t addViewer(const std::string& sourceId, const std::string& viewerId,
+        const RelayEndpoint& endpoint, std::string& previousSource, size_t& remaining);
+
+    // Bandwidth and temporal-layer ceiling for a viewer; 0 kbps and a
+    // negative temporal layer mean unlimited
+    void setViewerLimits(const std::string& viewerId, int maxKbps, int maxTemporal);
+
+    // Detach a viewer. Reports the source it was on and how many viewers
+    // that source has left, so idle sources can be closed.
+    bool removeViewer(const std::string& viewerId, std::string& sourceId, size_t& remaining);
+
+    bool hasSource(const std::string& sourceId) const;
+
+    // SSRC of the source's FEC repair stream; 0 when FEC is off
+    uint32_t fecSsrc(const std::string& sourceId) const;
+
+    // {"shards": n, "packets_in": n, "packets_out": n, "dropped": n, "sources": [...]}
+    cJSON* toJson() const;
+
+private:
+    static const size_t kBatch = 32;            // Packets per recvmmsg
+    static const size_t kMaxPacket = 2048;
+    static const size_t kSendBatch = 256;       // Messages per sendmmsg
+    static const size_t kFecSlots = 32;         // Repair packets per sendmmsg
+
+    static const uint8_t kAllTemporal = 7;
+
+    struct Viewer {
+        std::string id;
+        RelayEndpoint endpoint;
+
+        // Limits and the layers they select
+        int maxKbps = 0;
+        int maxTemporal = -1;
+        int targetLayer = 0;
+        uint8_t targetTemporal = kAllTemporal;
+
+        // Forwarding state; layer -1 until the first keyframe
+        int layer = -1;
+        uint8_t temporal = kAllTemporal;
+        uint16_t seqDelta = 0;
+        uint32_t timestampDelta = 0;
+        uint16_t lastSeq = 0;
+        uint32_t lastTimestamp = 0;
+        uint32_t lastInTimestamp = 0;
+        bool forwarded = false;
+
+        // Repair stream, sized from the loss in this viewer's reports
+        std::unique_ptr<FecEncoder> fec;
+        double loss = 0.0;
+    };
+
+    struct Source {
+        std::string id;
+        int fd = -1;
+        uint16_t port = 0;
+
+        // Declared layers; empty means one implicit layer
+        std::vector<RelayLayer> layers;
+        int frameMarkingId = 0;
+
+        // Implicit layer: keep numbering across sender restarts
+        uint32_t outSsrc = 0;
+        uint32_t fecSsrc = 0;
+        uint32_t inSsrc = 0;
+        bool seen = false;
+        uint16_t seqOffset = 0;
+        uint32_t timestampOffset = 0;
+        uint16_t lastSeq = 0;
+        uint32_t lastTimestamp = 0;
+
+        std::vector<Viewer> viewers;
+        uint64_t packets = 0;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<int, std::unique_ptr<Source>> sources;    // By socket
+        int epollFd = -1;
+        int sendFd = -1;
+        std::thread thread;
+
+        // Batch buffers, charged to the packet pool
+        uint8_t* buffers = nullptr;
+        std::vector<mmsghdr> sendMessages;
+        std::vector<iovec> sendVectors;             // Header, then shared rest
+        std::vector<uint8_t> sendHeaders;           // Per-viewer fixed headers
+        uint8_t* fecBuffers = nullptr;              // Repair packets awaiting send
+        size_t fecUsed = 0;
+
+        std::atomic<uint64_t> packetsIn{ 0 };
+        std::atomic<uint64_t> packetsOut{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> fecOut{ 0 };
+    };
+
+    DeviceConfig::RelaySettings settings;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> running;
+
+    // Control-plane index
+    mutable std::mutex controlMutex;
+    std::unordered_map<std::string, std::pair<Shard*, int>> sourceIndex;
+    std::unordered_map<std::string, std::string> viewerIndex;
+    uint16_t nextPort;
+    size_t nextShard;
+
+    int openPort(uint16_t& port);
+    void runShard(Shard* shard, ThreadPolicy policy);
+    void receive(Shard* shard, Source* source);
+    void receiveFeedback(Shard* shard);
+    void applyReport(Shard* shard, const sockaddr_storage& from, uint32_t ssrc, uint8_t fractionLost);
+    bool normalize(Source* source, RtpPacketView& packet);
+    int layerOf(const Source* source, const RtpPacketView& packet) const;
+    bool select(const Source* source, Viewer& viewer, int layer, const RtpPacketView& packet,
+        uint8_t* header);
+    static void retarget(const Source* source, Viewer& viewer);
+    void fanOut(Shard* shard, Source* source, const RtpPacketView* packets, const int* layers,
+        size_t count);
+};
+
+#endif // RTP_RELAY_H
\ No newline at end of file
@@ -0,0 +1,291 @@
+// src/SamplingProfiler.cpp
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <signal.h>
+#include "SamplingProfiler.h"
+#include <sys/time.h>
+#include <ucontext.h>
+#include <link.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+
+#include "Base64.h"
+
+namespace {
+    // Shared with the signal handler; sized before the timer is armed
+    uintptr_t* g_samples = nullptr;
+    size_t g_sampleCapacity = 0;
+    std::atomic<size_t> g_sampleCount(0);
+    std::atomic<size_t> g_sampleDropped(0);
+
+    std::mutex g_profileMutex;
+
+    uintptr_t programCounter(void* context) {
+        ucontext_t* uc = static_cast<ucontext_t*>(context);
+#if defined(__x86_64__)
+        return static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__i386__)
+        return static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_EIP]);
+#elif defined(__aarch64__)
+        return static_cast<uintptr_t>(uc->uc_mcontext.pc);
+#elif defined(__arm__)
+        return static_cast<uintptr_t>(uc->uc_mcontext.arm_pc);
+#else
+        (void)uc;
+        return 0;
+#endif
+    }
+
+    void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    std::string hexString(const uint8_t* data, size_t len) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(len * 2);
+        for (size_t i = 0; i < len; i++) {
+            out.push_back(digits[data[i] >> 4]);
+            out.push_back(digits[data[i] & 15]);
+        }
+        return out;
+    }
+
+    // Pull NT_GNU_BUILD_ID out of a loaded object's PT_NOTE segments
+    std::string findBuildId(const struct dl_phdr_info* info) {
+        for (int i = 0; i < info->dlpi_phnum; i++) {
+            const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+            if (phdr.p_type != PT_NOTE) {
+                continue;
+            }
+
+            const uint8_t* note = reinterpret_cast<const uint8_t*>(info->dlpi_addr + phdr.p_vaddr);
+            const uint8_t* end = note + phdr.p_memsz;
+            while (note + sizeof(ElfW(Nhdr)) <= end) {
+                const ElfW(Nhdr)* header = reinterpret_cast<const ElfW(Nhdr)*>(note);
+                const uint8_t* name = note + sizeof(ElfW(Nhdr));
+                const uint8_t* desc = name + ((header->n_namesz + 3) & ~3u);
+
+                if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 &&
+                    memcmp(name, "GNU", 4) == 0 && desc + header->n_descsz <= end) {
+                    return hexString(desc, header->n_descsz);
+                }
+
+                note = desc + ((header->n_descsz + 3) & ~3u);
+            }
+        }
+        return std::string();
+    }
+
+    int collectModule(struct dl_phdr_info* info, size_t, void* data) {
+        auto* modules = static_cast<std::vector<SamplingProfiler::Module>*>(data);
+
+        SamplingProfiler::Module module;
+        module.path = (info->dlpi_name && info->dlpi_name[0]) ? info->dlpi_name : "[exe]";
+        module.base = static_cast<uintptr_t>(info->dlpi_addr);
+        module.buildId = findBuildId(info);
+        modules->push_back(module);
+        return 0;
+    }
+}
+
+const int SamplingProfiler::kMaxDurationSecs;
+const int SamplingProfiler::kMaxFrequencyHz;
+
+void SamplingProfiler::onSignal(int, siginfo_t*, void* context) {
+    size_t index = g_sampleCount.fetch_add(1, std::memory_order_relaxed);
+    if (index < g_sampleCapacity) {
+        g_samples[index] = programCounter(context);
+    }
+    else {
+        g_sampleDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<SamplingProfiler::Module> SamplingProfiler::loadModules() {
+    std::vector<Module> modules;
+    dl_iterate_phdr(collectModule, &modules);
+    return modules;
+}
+
+bool SamplingProfiler::collect(int durationSecs, int frequencyHz, Profile& profile) {
+    std::unique_lock<std::mutex> lock(g_profileMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+
+    durationSecs = std::max(1, std::min(durationSecs, kMaxDurationSecs));
+    frequencyHz = std::max(1, std::min(frequencyHz, kMaxFrequencyHz));
+
+    // ITIMER_PROF counts process CPU time, so busy cores multiply the rate
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t capacity = static_cast<size_t>(durationSecs) * frequencyHz * cores + 64;
+    std::unique_ptr<uintptr_t[]> samples(new uintptr_t[capacity]);
+
+    g_samples = samples.get();
+    g_sampleCapacity = capacity;
+    g_sampleCount = 0;
+    g_sampleDropped = 0;
+
+    struct sigaction action;
+    struct sigaction previous;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &SamplingProfiler::onSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &previous) != 0) {
+        return false;
+    }
+
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    // tv_usec must stay below one second, so 1 Hz goes in tv_sec
+    long intervalUs = 1000000L / frequencyHz;
+    timer.it_interval.tv_sec = intervalUs / 1000000;
+    timer.it_interval.tv_usec = intervalUs % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        sigaction(SIGPROF, &previous, nullptr);
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(durationSecs));
+
+    // Disarm, then let any in-flight handler finish before restoring
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    sigaction(SIGPROF, &previous, nullptr);
+
+    size_t count = std::min(g_sampleCount.load(), capacity);
+    g_samples = nullptr;
+    g_sampleCapacity = 0;
+
+    profile.durationSecs = durationSecs;
+    profile.frequencyHz = frequencyHz;
+    profile.samples = count;
+    profile.dropped = g_sampleDropped.load();
+    profile.modules = loadModules();
+    profile.hotspots.clear();
+
+    // Fold identical program counters
+    std::unordered_map<uintptr_t, uint32_t> histogram;
+    for (size_t i = 0; i < count; i++) {
+        histogram[samples[i]]++;
+    }
+
+    for (const auto& entry : histogram) {
+        Hotspot hotspot;
+        hotspot.module = -1;
+        hotspot.offset = entry.first;
+        hotspot.count = entry.second;
+
+        Dl_info dlInfo;
+        if (entry.first && dladdr(reinterpret_cast<void*>(entry.first), &dlInfo)) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(dlInfo.dli_fbase);
+            for (size_t m = 0; m < profile.modules.size(); m++) {
+                if (profile.modules[m].base == base) {
+                    hotspot.module = static_cast<int>(m);
+                    hotspot.offset = entry.first - base;
+                    break;
+                }
+            }
+
+            // A non-PIE executable has load bias 0 and keeps absolute
+            // addresses, which are already stable across runs
+            if (hotspot.module < 0 && !profile.modules.empty() &&
+                profile.modules[0].base == 0 && dlInfo.dli_fname &&
+                profile.modules[0].path == "[exe]") {
+                hotspot.module = 0;
+            }
+            if (dlInfo.dli_sname) {
+                hotspot.symbol = dlInfo.dli_sname;
+            }
+        }
+
+        profile.hotspots.push_back(hotspot);
+    }
+
+    std::sort(profile.hotspots.begin(), profile.hotspots.end(),
+        [](const Hotspot& a, const Hotspot& b) { return a.count > b.count; });
+
+    return true;
+}
+
+cJSON* SamplingProfiler::toJson(const Profile& profile, size_t topSymbols) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "duration", profile.durationSecs);
+    cJSON_AddNumberToObject(root, "hz", profile.frequencyHz);
+    cJSON_AddNumberToObject(root, "samples", static_cast<double>(profile.samples));
+    cJSON_AddNumberToObject(root, "dropped", static_cast<double>(profile.dropped));
+
+    // Per-module histograms sorted by offset, so deltas stay small
+    cJSON* modules = cJSON_AddArrayToObject(root, "modules");
+    for (int m = -1; m < static_cast<int>(profile.modules.size()); m++) {
+        std::vector<const Hotspot*> entries;
+        for (const auto& hotspot : profile.hotspots) {
+            if (hotspot.module == m) {
+                entries.push_back(&hotspot);
+            }
+        }
+        if (entries.empty()) {
+            continue;
+        }
+
+        std::sort(entries.begin(), entries.end(),
+            [](const Hotspot* a, const Hotspot* b) { return a->offset < b->offset; });
+
+        std::vector<uint8_t> encoded;
+        uintptr_t previous = 0;
+        for (const Hotspot* hotspot : entries) {
+            appendVarint(encoded, hotspot->offset - previous);
+            appendVarint(encoded, hotspot->count);
+            previous = hotspot->offset;
+        }
+
+        cJSON* module = cJSON_CreateObject();
+        if (m >= 0) {
+            cJSON_AddStringToObject(module, "path", profile.modules[m].path.c_str());
+            cJSON_AddStringToObject(module, "build_id", profile.modules[m].buildId.c_str());
+        }
+        else {
+            cJSON_AddStringToObject(module, "path", "[unknown]");
+        }
+        cJSON_AddStringToObject(module, "histogram",
+            base64Encode(encoded.data(), encoded.size()).c_str());
+        cJSON_AddItemToArray(modules, module);
+    }
+
+    // Top hotspots with whatever symbols dladdr could find
+    cJSON* top = cJSON_AddArrayToObject(root, "top");
+    for (size_t i = 0; i < profile.hotspots.size() && i < topSymbols; i++) {
+        const Hotspot& hotspot = profile.hotspots[i];
+
+        char offset[32];
+        snprintf(offset, sizeof(offset), "0x%llx", static_cast<unsigned long long>(hotspot.offset));
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "module", hotspot.module);
+        cJSON_AddStringToObject(item, "offset", offset);
+        cJSON_AddNumberToObject(item, "count", hotspot.count);
+        if (!hotspot.symbol.empty()) {
+            cJSON_AddStringToObject(item, "symbol", hotspot.symbol.c_str());
+        }
+        cJSON_AddItemToArray(top, item);
+    }
+
+    return root;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+// include/SamplingProfiler.h
+#ifndef SAMPLING_PROFILER_H
+#define SAMPLING_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <csignal>
+#include <cjson/cJSON.h>
+
+// Whole-process CPU sampling profiler based on SIGPROF/ITIMER_PROF.
+//
+// The signal handler only stores the interrupted program counter into a
+// preallocated array, so it is async-signal-safe and cheap enough to run
+// on production devices. Aggregation, symbolisation and encoding happen
+// after sampling stops, on the calling thread.
+class SamplingProfiler {
+public:
+    struct Module {
+        std::string path;
+        uintptr_t base;
+        std::string buildId;    // Hex GNU build-id, empty if absent
+    };
+
+    // One distinct program counter and how often it was hit
+    struct Hotspot {
+        int module;             // Index into modules, -1 if unresolved
+        uintptr_t offset;       // Module-relative (or absolute if unresolved)
+        uint32_t count;
+        std::string symbol;     // Demangling is left to the backend
+    };
+
+    struct Profile {
+        int durationSecs;
+        int frequencyHz;
+        uint64_t samples;
+        uint64_t dropped;
+        std::vector<Module> modules;
+        std::vector<Hotspot> hotspots;   // Sorted by count, descending
+    };
+
+    static const int kMaxDurationSecs = 60;
+    static const int kMaxFrequencyHz = 1000;
+
+    // Blocks for durationSecs; only one profile may run at a time
+    static bool collect(int durationSecs, int frequencyHz, Profile& profile);
+
+    // Compact form for the wire: per-module histograms of
+    // (offset delta, count) pairs as LEB128 varints, base64-encoded, plus
+    // the top symbolised hotspots for a quick look
+    static cJSON* toJson(const Profile& profile, size_t topSymbols = 32);
+
+private:
+    static void onSignal(int signum, siginfo_t* info, void* context);
+    static std::vector<Module> loadModules();
+};
+
+#endif // SAMPLING_PROFILER_H
\ No newline at end of file
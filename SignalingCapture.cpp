@@ -0,0 +1,213 @@
+// src/SignalingCapture.cpp
+#include "SignalingCapture.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char SignalingCapture::kMagic[8] = { 'K', 'N', 'S', 'I', 'G', 'C', 'A', 'P' };
+
+namespace {
+    const size_t kMinFileBytes = 64 * 1024;
+
+    uint64_t monotonicNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    std::string rotatedName(const std::string& path, int index) {
+        return index == 0 ? path : path + "." + std::to_string(index);
+    }
+}
+
+// Constructor and Destructor
+SignalingCapture::SignalingCapture(const std::string& capturePath, size_t bytes, int count)
+    : path(capturePath),
+    fileBytes(bytes < kMinFileBytes ? kMinFileBytes : bytes),
+    files(count < 1 ? 1 : count),
+    fd(-1),
+    map(nullptr),
+    used(0),
+    recorded(0),
+    dropped(0) {
+
+    // Keep the previous run's capture
+    rotate();
+    openFile();
+}
+
+SignalingCapture::~SignalingCapture() {
+    closeFile();
+}
+
+// File handling
+bool SignalingCapture::openFile() {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_WARN("Could not open signaling capture %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(fileBytes)) != 0) {
+        LOG_WARN("Could not size signaling capture %s: %s", path, strerror(errno));
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_WARN("Could not map signaling capture %s: %s", path, strerror(errno));
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    map = static_cast<uint8_t*>(mapping);
+    memcpy(map, kMagic, sizeof(kMagic));
+    used = sizeof(kMagic);
+    return true;
+}
+
+void SignalingCapture::closeFile() {
+    if (map) {
+        munmap(map, fileBytes);
+        map = nullptr;
+    }
+    if (fd >= 0) {
+        // Drop the unused tail
+        if (ftruncate(fd, static_cast<off_t>(used)) != 0) {
+            LOG_WARN("Could not trim signaling capture %s", path);
+        }
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void SignalingCapture::rotate() {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return;
+    }
+
+    remove(rotatedName(path, files - 1).c_str());
+    for (int index = files - 1; index > 0; index--) {
+        rename(rotatedName(path, index - 1).c_str(), rotatedName(path, index).c_str());
+    }
+}
+
+// Recording
+void SignalingCapture::record(Direction direction, const char* data, size_t length) {
+    size_t needed = kRecordHeaderSize + length;
+    if (needed > fileBytes - sizeof(kMagic) || length == 0) {
+        dropped++;
+        return;
+    }
+
+    if (map && used + needed > fileBytes) {
+        closeFile();
+        rotate();
+        openFile();
+    }
+    if (!map) {
+        dropped++;
+        return;
+    }
+
+    uint32_t recordLength = static_cast<uint32_t>(length);
+    uint64_t timestampNs = monotonicNanos();
+    uint8_t* p = map + used;
+    memcpy(p, &recordLength, 4);
+    p[4] = direction;
+    memcpy(p + 5, &timestampNs, 8);
+    memcpy(p + kRecordHeaderSize, data, length);
+
+    used += needed;
+    recorded++;
+}
+
+// Reader
+SignalingCaptureReader::SignalingCaptureReader()
+    : fd(-1),
+    map(nullptr),
+    size(0),
+    offset(0) {
+}
+
+SignalingCaptureReader::~SignalingCaptureReader() {
+    close();
+}
+
+bool SignalingCaptureReader::open(const std::string& path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SignalingCapture::kMagic)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    map = static_cast<const uint8_t*>(mapping);
+
+    if (memcmp(map, SignalingCapture::kMagic, sizeof(SignalingCapture::kMagic)) != 0) {
+        close();
+        return false;
+    }
+
+    madvise(const_cast<uint8_t*>(map), size, MADV_SEQUENTIAL);
+    offset = sizeof(SignalingCapture::kMagic);
+    return true;
+}
+
+void SignalingCaptureReader::close() {
+    if (map) {
+        munmap(const_cast<uint8_t*>(map), size);
+        map = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    size = 0;
+    offset = 0;
+}
+
+bool SignalingCaptureReader::next(Record& record) {
+    if (!map || offset + SignalingCapture::kRecordHeaderSize > size) {
+        return false;
+    }
+
+    const uint8_t* p = map + offset;
+    uint32_t length;
+    memcpy(&length, p, 4);
+
+    // Zero length is the unwritten tail of an untrimmed file
+    if (length == 0 || p[4] > SignalingCapture::OUTBOUND ||
+        offset + SignalingCapture::kRecordHeaderSize + length > size) {
+        return false;
+    }
+
+    record.direction = static_cast<SignalingCapture::Direction>(p[4]);
+    memcpy(&record.timestampNs, p + 5, 8);
+    record.data = reinterpret_cast<const char*>(p + SignalingCapture::kRecordHeaderSize);
+    record.length = length;
+
+    offset += SignalingCapture::kRecordHeaderSize + length;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+// include/SignalingCapture.h
+#ifndef SIGNALING_CAPTURE_H
+#define SIGNALING_CAPTURE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Binary log of signaling frames for reproducing field issues.
+//
+// Each file starts with an 8-byte magic and holds records of
+//   u32 payload length | u8 direction | u64 monotonic ns | payload
+// in host byte order, written straight into a fixed-size mmapped file.
+// When a record does not fit, the file is trimmed to what was used and
+// rotated logrotate-style: the live file is <path>, older ones are
+// <path>.1 (newest) to <path>.<files - 1>. A crash leaves the unwritten
+// tail zero-filled, which readers take as the end.
+//
+// Not thread-safe: SignalingClient records from its event loop only.
+class SignalingCapture {
+public:
+    enum Direction : uint8_t {
+        INBOUND = 0,
+        OUTBOUND = 1
+    };
+
+    static const char kMagic[8];
+    static const size_t kRecordHeaderSize = 13;
+
+    SignalingCapture(const std::string& path, size_t fileBytes, int files);
+    ~SignalingCapture();
+
+    SignalingCapture(const SignalingCapture&) = delete;
+    SignalingCapture& operator=(const SignalingCapture&) = delete;
+
+    bool isOpen() const { return map != nullptr; }
+
+    void record(Direction direction, const char* data, size_t length);
+
+    uint64_t getRecorded() const { return recorded; }
+    uint64_t getDropped() const { return dropped; }
+
+private:
+    std::string path;
+    size_t fileBytes;
+    int files;
+
+    int fd;
+    uint8_t* map;
+    size_t used;
+
+    uint64_t recorded;
+    uint64_t dropped;
+
+    bool openFile();
+    void closeFile();
+    void rotate();
+};
+
+// Sequential reader for one capture file
+class SignalingCaptureReader {
+public:
+    struct Record {
+        SignalingCapture::Direction direction;
+        uint64_t timestampNs;
+        const char* data;
+        size_t length;
+    };
+
+    SignalingCaptureReader();
+    ~SignalingCaptureReader();
+
+    SignalingCaptureReader(const SignalingCaptureReader&) = delete;
+    SignalingCaptureReader& operator=(const SignalingCaptureReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Valid until the next call or close(); false at the end
+    bool next(Record& record);
+
+private:
+    int fd;
+    const uint8_t* map;
+    size_t size;
+    size_t offset;
+};
+
+#endif // SIGNALING_CAPTURE_H
\ No newline at end of file
@@ -1,16 +1,47 @@
 // src/SignalingClient.cpp
 #include "SignalingClient.h"
+#include "Logger.h"
+#include "Watchdog.h"
 #include <thread>
 #include <chrono>
 #include <stdexcept>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/sockios.h>
+
+namespace {
+    const std::chrono::seconds kLinkSampleInterval(1);
+
+    // Waits for the websocket handshake and for a closed socket to go
+    const std::chrono::seconds kConnectTimeout(5);
+    const std::chrono::seconds kCloseTimeout(1);
+
+    // Frames written per writable callback while the kernel keeps up
+    const size_t kMaxWriteBatch = 16;
+
+    // Socket buffer backlog beyond which writes go one at a time
+    const uint32_t kSendQueueHigh = 64 * 1024;
+
+    // Reassembled inbound messages; the server's own limit is 64 kB
+    const size_t kMaxMessageBytes = 256 * 1024;
+    const size_t kRxBufferKeep = 1024;
+}
 
 SignalingClient::SignalingClient(const std::string& url)
     : serverUrl(url),
     context(nullptr),
     wsi(nullptr),
+    closingWsi(nullptr),
     connected(false),
     running(false),
-    messageCallback(nullptr) {
+    messageCallback(nullptr),
+    chokedTotal(0),
+    choked(false),
+    chokes(0),
+    chokesAtSample(0),
+    writeBatch(1),
+    eventLoopPolicy("rtc-signaling") {
 
     // Initialize libwebsockets context
     struct lws_context_creation_info info;
@@ -20,6 +51,7 @@ SignalingClient::SignalingClient(const std::string& url)
     info.protocols = protocols;
     info.gid = -1;
     info.uid = -1;
+    info.user = this;
 
     context = lws_create_context(&info);
     if (!context) {
@@ -36,10 +68,14 @@ SignalingClient::~SignalingClient() {
     }
 }
 
+// Blocks until the handshake completes, fails or times out
 bool SignalingClient::connect() {
     if (connected) {
         return true;
     }
+    if (wsi) {
+        closeConnection();
+    }
 
     struct lws_client_connect_info ccinfo;
     memset(&ccinfo, 0, sizeof(ccinfo));
@@ -51,33 +87,65 @@ bool SignalingClient::connect() {
     ccinfo.host = ccinfo.address;
     ccinfo.origin = ccinfo.address;
     ccinfo.protocol = "signaling";
-    ccinfo.pwsi = &wsi;
 
-    // Connect to the server
+    // Connect to the server. wsi is only ever set here and cleared by this
+    // connection's own CLOSED/CONNECTION_ERROR, so a callback can always
+    // tell the current connection from an old one.
     struct lws* connection = lws_client_connect_via_info(&ccinfo);
 
     if (!connection) {
         return false;
     }
+    wsi = connection;
+
+    // connected is set by CLIENT_ESTABLISHED; a failed attempt clears wsi.
+    // Without an event loop we service the context ourselves.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + kConnectTimeout;
+    while (!connected && wsi && std::chrono::steady_clock::now() < deadline) {
+        if (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        else {
+            lws_service(context, 50);
+        }
+    }
 
-    connected = true;
-    return true;
+    if (!connected && wsi && !running) {
+        closeConnection();
+    }
+    return connected;
 }
 
 void SignalingClient::disconnect() {
-    if (!connected) {
-        return;
-    }
-
+    // Always joined: the loop outlives a connection dropped by the server
     stopEventLoop();
 
-    // Close the websocket connection
     if (wsi) {
-        lws_close_reason(wsi, LWS_CLOSE_STATUS_NORMAL, NULL, 0);
-        wsi = nullptr;
+        closeConnection();
     }
 
     connected = false;
+    clearLinkStats();
+}
+
+// Event loop stopped. lws has no synchronous close: the connection is
+// detached from wsi, so its late callbacks are ignored, and closed by
+// returning -1 from the next one. The timeout reaps a socket that is
+// still connecting and never becomes writable.
+void SignalingClient::closeConnection() {
+    closingWsi = wsi;
+    wsi = nullptr;
+    connected = false;
+
+    lws_close_reason(closingWsi, LWS_CLOSE_STATUS_NORMAL, NULL, 0);
+    lws_set_timeout(closingWsi, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_ASYNC);
+    lws_callback_on_writable(closingWsi);
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + kCloseTimeout;
+    while (closingWsi && std::chrono::steady_clock::now() < deadline) {
+        lws_service(context, 50);
+    }
+    closingWsi = nullptr;
 }
 
 bool SignalingClient::isConnected() const {
@@ -89,23 +157,182 @@ void SignalingClient::sendMessage(const SignalingMessage& message) {
         throw std::runtime_error("Not connected to signaling server");
     }
 
-    std::string serializedMsg = message.serialize();
+    bool queued;
+    if (reliability) {
+        // Stamping seq/ack needs a mutable copy. A sequenced message that
+        // is shed here is still retransmitted once the queue drains.
+        SignalingMessage outbound(message);
+        queued = queueFrame(reliability->prepareOutbound(outbound));
+    }
+    else {
+        queued = queueFrame(message.serialize());
+    }
+
+    if (!queued) {
+        throw std::runtime_error("Signaling send queue over memory budget");
+    }
+}
+
+void SignalingClient::sendMessage(PreparedMessage& message) {
+    if (!connected) {
+        throw std::runtime_error("Not connected to signaling server");
+    }
+
+    bool queued = reliability ?
+        queueFrame(reliability->prepareOutbound(message)) :
+        queueFrame(message.serialize());
+
+    if (!queued) {
+        throw std::runtime_error("Signaling send queue over memory budget");
+    }
+}
+
+void SignalingClient::setReliableDelivery(bool enabled, const ReliableChannel::Options& options) {
+    if (enabled) {
+        reliability.reset(new ReliableChannel(timers,
+            [this](const std::string& frame) { queueFrame(frame); }, options));
+    }
+    else {
+        reliability.reset();
+    }
+}
+
+bool SignalingClient::queueFrame(const std::string& serialized) {
+    if (!MemoryAccounting::withinBudget(MemoryTag::QUEUES, LWS_PRE + serialized.size())) {
+        return false;
+    }
+
+    // Reserve LWS_PRE bytes so the frame can be written in place
+    QueuedFrame frame(LWS_PRE, '\0');
+    frame.append(serialized.data(), serialized.size());
+
+    {
+        std::lock_guard<std::mutex> lock(txMutex);
+        txQueue.push_back(std::move(frame));
+    }
+
+    // lws_write is only safe on the service thread; wake it up
+    lws_cancel_service(context);
+    return true;
+}
+
+void SignalingClient::onWritable() {
+    // Writable again: whatever choked the pipe has drained
+    if (choked) {
+        chokedTotal += std::chrono::steady_clock::now() - chokedSince;
+        choked = false;
+    }
+
+    // Several frames per callback while the pipe keeps taking them
+    for (size_t written = 0; written < writeBatch; written++) {
+        QueuedFrame frame;
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(txMutex);
+            if (txQueue.empty()) {
+                return;
+            }
+            frame = std::move(txQueue.front());
+            txQueue.pop_front();
+            more = !txQueue.empty();
+        }
+
+        size_t payloadLen = frame.size() - LWS_PRE;
+        int n = lws_write(wsi,
+            reinterpret_cast<unsigned char*>(&frame[LWS_PRE]),
+            payloadLen, LWS_WRITE_TEXT);
+
+        if (n < static_cast<int>(payloadLen)) {
+            LOG_ERROR("Failed to send complete message");
+            return;
+        }
+
+        if (capture) {
+            capture->record(SignalingCapture::OUTBOUND, &frame[LWS_PRE], payloadLen);
+        }
+
+        if (!more) {
+            return;
+        }
+        if (lws_send_pipe_choked(wsi)) {
+            choked = true;
+            chokedSince = std::chrono::steady_clock::now();
+            chokes++;
+            break;
+        }
+    }
 
-    // Allocate buffer with lws protocol requirements
-    size_t bufLen = LWS_PRE + serializedMsg.length();
-    unsigned char* buf = new unsigned char[bufLen];
+    lws_callback_on_writable(wsi);
+}
 
-    // Copy message to buffer after LWS_PRE
-    memcpy(buf + LWS_PRE, serializedMsg.c_str(), serializedMsg.length());
+// Link quality
+void SignalingClient::sampleLink() {
+    LinkStats sample;
+    {
+        std::lock_guard<std::mutex> lock(txMutex);
+        sample.queuedFrames = txQueue.size();
+    }
 
-    // Send via libwebsockets
-    int n = lws_write(wsi, buf + LWS_PRE, serializedMsg.length(), LWS_WRITE_TEXT);
+    int fd = wsi ? lws_get_socket_fd(wsi) : -1;
+    if (fd >= 0) {
+        struct tcp_info info;
+        socklen_t length = sizeof(info);
+        if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+            sample.valid = true;
+            sample.rttUs = info.tcpi_rtt;
+            sample.rttVarUs = info.tcpi_rttvar;
+            sample.retransmits = info.tcpi_total_retrans;
+            sample.unacked = info.tcpi_unacked;
+        }
 
-    delete[] buf;
+        int queued = 0;
+        if (ioctl(fd, SIOCOUTQ, &queued) == 0 && queued > 0) {
+            sample.sendQueueBytes = static_cast<uint32_t>(queued);
+        }
+    }
 
-    if (n < serializedMsg.length()) {
-        throw std::runtime_error("Failed to send complete message");
+    std::chrono::steady_clock::duration chokedFor = chokedTotal;
+    if (choked) {
+        chokedFor += std::chrono::steady_clock::now() - chokedSince;
     }
+    sample.chokedMs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(chokedFor).count());
+    sample.chokes = chokes;
+
+    // Batch while the kernel keeps up; once it backs up, one frame per
+    // callback so frames wait in our queue rather than in lws buffers
+    bool backedUp = chokes != chokesAtSample || sample.sendQueueBytes > kSendQueueHigh;
+    writeBatch = backedUp ? 1 : kMaxWriteBatch;
+    chokesAtSample = chokes;
+    sample.writeBatch = writeBatch;
+
+    std::lock_guard<std::mutex> lock(linkMutex);
+    linkStats = sample;
+}
+
+void SignalingClient::clearLinkStats() {
+    std::lock_guard<std::mutex> lock(linkMutex);
+    linkStats.valid = false;
+}
+
+SignalingClient::LinkStats SignalingClient::getLinkStats() const {
+    std::lock_guard<std::mutex> lock(linkMutex);
+    return linkStats;
+}
+
+cJSON* SignalingClient::LinkStats::toJson() const {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "valid", valid);
+    cJSON_AddNumberToObject(json, "rtt_ms", rttUs / 1000.0);
+    cJSON_AddNumberToObject(json, "rttvar_ms", rttVarUs / 1000.0);
+    cJSON_AddNumberToObject(json, "retransmits", retransmits);
+    cJSON_AddNumberToObject(json, "unacked", unacked);
+    cJSON_AddNumberToObject(json, "send_queue_bytes", sendQueueBytes);
+    cJSON_AddNumberToObject(json, "queued_frames", static_cast<double>(queuedFrames));
+    cJSON_AddNumberToObject(json, "choked_ms", static_cast<double>(chokedMs));
+    cJSON_AddNumberToObject(json, "chokes", chokes);
+    cJSON_AddNumberToObject(json, "write_batch", static_cast<double>(writeBatch));
+    return json;
 }
 
 void SignalingClient::setMessageCallback(MessageCallback callback) {
@@ -113,6 +340,30 @@ void SignalingClient::setMessageCallback(MessageCallback callback) {
     messageCallback = callback;
 }
 
+void SignalingClient::setServerUrl(const std::string& url) {
+    if (connected) {
+        LOG_WARN("Ignoring server change while connected");
+        return;
+    }
+    serverUrl = url;
+}
+
+void SignalingClient::setCapture(const std::string& path, size_t fileBytes, int files) {
+    capture.reset(new SignalingCapture(path, fileBytes, files));
+    if (!capture->isOpen()) {
+        capture.reset();
+    }
+}
+
+void SignalingClient::replayFrame(const char* data, size_t len) {
+    std::string frame(data, len);
+    processIncomingMessage(&frame[0], len);
+}
+
+void SignalingClient::setThreadPolicy(const ThreadPolicy& policy) {
+    eventLoopPolicy = policy;
+}
+
 void SignalingClient::startEventLoop() {
     // Continued from previous implementation
     if (running) {
@@ -131,21 +382,73 @@ void SignalingClient::stopEventLoop() {
 }
 
 void SignalingClient::runEventLoop() {
-    while (running && connected) {
-        // Service any pending libwebsockets events
+    eventLoopPolicy.apply();
+    WatchdogLease watchdog(eventLoopPolicy.name.c_str());
+
+    // Runs until stopped, also while disconnected, so a connection lost
+    // here is noticed by the owner and replaced through connect()
+    while (running) {
+        watchdog.kick();
+
+        // Service any pending libwebsockets events; sends wake us early
         lws_service(context, 50);
 
-        // Small sleep to prevent tight looping
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Retransmission and ack timers
+        timers.advance();
+
+        // Link quality, which also sets the write batch
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= nextLinkSample) {
+            sampleLink();
+            nextLinkSample = now + kLinkSampleInterval;
+        }
+    }
+}
+
+void SignalingClient::onReceive(struct lws* wsi, const char* data, size_t len) {
+    if (rxBuffer.size() + len > kMaxMessageBytes) {
+        LOG_WARN("Dropping oversized message from server");
+        releaseRxBuffer();
+        return;
+    }
+
+    // lws hands over at most its rx buffer at a time; large SDP offers
+    // arrive in several pieces
+    rxBuffer.append(data, len);
+    if (!lws_is_final_fragment(wsi) || lws_remaining_packet_payload(wsi) > 0) {
+        return;
+    }
+
+    // Recorded first: parsing unescapes the buffer in place
+    if (capture) {
+        capture->record(SignalingCapture::INBOUND, rxBuffer.data(), rxBuffer.size());
+    }
+    processIncomingMessage(&rxBuffer[0], rxBuffer.size());
+    releaseRxBuffer();
+}
+
+void SignalingClient::releaseRxBuffer() {
+    // Don't pin a large reassembly buffer between messages
+    if (rxBuffer.capacity() > kRxBufferKeep) {
+        std::string().swap(rxBuffer);
+    }
+    else {
+        rxBuffer.clear();
     }
 }
 
-void SignalingClient::processIncomingMessage(const char* data, size_t len) {
+void SignalingClient::processIncomingMessage(char* data, size_t len) {
     try {
-        // Deserialize the message
-        SignalingMessage message = SignalingMessage::deserialize(
-            std::string(data, len)
-        );
+        // Deserialize the message; parsing consumes data
+        SignalingMessage message = SignalingMessage::deserializeInPlace(data, len);
+
+        // Consume seq/ack; retransmitted duplicates stop here
+        if (reliability && !reliability->processInbound(message)) {
+            return;
+        }
+        if (message.getType() == SignalingMessageType::ACK) {
+            return;
+        }
 
         // If a callback is set, invoke it
         std::lock_guard<std::mutex> lock(messageMutex);
@@ -154,13 +457,12 @@ void SignalingClient::processIncomingMessage(const char* data, size_t len) {
         }
         else {
             // Alternatively, store in a queue if no callback is set
-            incomingMessages.push(message);
+            incomingMessages.push(std::move(message));
         }
     }
     catch (const std::exception& e) {
         // Log deserialization errors
-        // In a real implementation, use proper logging
-        fprintf(stderr, "Message deserialization error: %s\n", e.what());
+        LOG_ERROR("Message deserialization error: %s", e.what());
     }
 }
 
@@ -176,29 +478,70 @@ int SignalingClient::callback_signaling(
         lws_context_user(lws_get_context(wsi))
         );
 
+    // A connection being closed, or replaced since, must not touch the
+    // state of the current one
+    if (wsi != client->wsi) {
+        switch (reason) {
+        case LWS_CALLBACK_CLIENT_ESTABLISHED:
+        case LWS_CALLBACK_CLIENT_WRITEABLE:
+        case LWS_CALLBACK_CLIENT_RECEIVE:
+            return -1;
+        case LWS_CALLBACK_CLIENT_CLOSED:
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        case LWS_CALLBACK_WSI_DESTROY:
+            if (wsi == client->closingWsi) {
+                client->closingWsi = nullptr;
+            }
+            return 0;
+        default:
+            break;
+        }
+    }
+
     switch (reason) {
     case LWS_CALLBACK_CLIENT_ESTABLISHED:
-        printf("WebSocket connection established\n");
+        LOG_INFO("WebSocket connection established");
         client->connected = true;
+        client->releaseRxBuffer();
+
+        // Sequencing is per connection; anything unacknowledged from a
+        // previous one goes again, renumbered
+        if (client->reliability) {
+            client->reliability->startSession();
+        }
+        lws_callback_on_writable(wsi);
         break;
 
-    case LWS_CALLBACK_CLIENT_RECEIVE: {
-        // Process incoming WebSocket message
-        client->processIncomingMessage(
-            static_cast<const char*>(in),
-            len
-        );
+    case LWS_CALLBACK_CLIENT_WRITEABLE:
+        client->onWritable();
+        break;
+
+    case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
+        // Woken by queueFrame() from another thread
+        std::lock_guard<std::mutex> lock(client->txMutex);
+        if (client->wsi && !client->txQueue.empty()) {
+            lws_callback_on_writable(client->wsi);
+        }
         break;
     }
 
+    case LWS_CALLBACK_CLIENT_RECEIVE:
+        // Process incoming WebSocket message once it is complete
+        client->onReceive(wsi, static_cast<const char*>(in), len);
+        break;
+
     case LWS_CALLBACK_CLIENT_CLOSED:
-        printf("WebSocket connection closed\n");
+        LOG_WARN("WebSocket connection closed");
         client->connected = false;
+        client->wsi = nullptr;
+        client->clearLinkStats();
         break;
 
     case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
-        printf("WebSocket connection error\n");
+        LOG_ERROR("WebSocket connection error");
         client->connected = false;
+        client->wsi = nullptr;
+        client->clearLinkStats();
         break;
 
     default:
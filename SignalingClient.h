@@ -8,9 +8,18 @@
 #include <atomic>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <chrono>
 
 #include "SignalingProtocol.h"
+#include "TimerWheel.h"
+#include "ReliableChannel.h"
+#include "SignalingCapture.h"
+#include "MessageTemplate.h"
+#include "MemoryAccounting.h"
+#include "ThreadPolicy.h"
 
 class SignalingClient {
 public:
@@ -22,14 +31,56 @@ public:
     void disconnect();
     bool isConnected() const;
 
-    // Message handling
+    // Message handling; safe to call from any thread. Throws when the
+    // outbound queue is over its memory budget.
     void sendMessage(const SignalingMessage& message);
 
+    // Rendered from a MessageTemplate; seq/ack are stamped in place
+    void sendMessage(PreparedMessage& message);
+
+    // Optional at-least-once delivery for critical messages
+    void setReliableDelivery(bool enabled,
+        const ReliableChannel::Options& options = ReliableChannel::Options());
+
+    // Quality of the websocket's TCP connection, sampled once a second on
+    // the event loop from TCP_INFO and the kernel send queue
+    struct LinkStats {
+        bool valid = false;
+        uint32_t rttUs = 0;
+        uint32_t rttVarUs = 0;
+        uint32_t retransmits = 0;           // Since the connection opened
+        uint32_t unacked = 0;               // Segments in flight
+        uint32_t sendQueueBytes = 0;        // In the socket buffer, sent or not
+        size_t queuedFrames = 0;            // Not yet handed to lws
+        uint64_t chokedMs = 0;              // lws send pipe choked, cumulative
+        uint32_t chokes = 0;
+        size_t writeBatch = 1;              // Frames per writable callback
+
+        // {"rtt_ms": n, "rttvar_ms": n, "retransmits": n, "unacked": n,
+        //  "send_queue_bytes": n, "queued_frames": n, "choked_ms": n,
+        //  "chokes": n, "write_batch": n}
+        cJSON* toJson() const;
+    };
+    LinkStats getLinkStats() const;
+
+    // Server for the next connect(); ignored while connected
+    void setServerUrl(const std::string& url);
+
     // Callback registration for incoming messages
     typedef std::function<void(const SignalingMessage&)> MessageCallback;
     void setMessageCallback(MessageCallback callback);
 
-    // Event loop management
+    // Record every frame sent and received; call before the event loop
+    // starts. See SignalingCapture for the file layout.
+    void setCapture(const std::string& path, size_t fileBytes, int files);
+
+    // Feed a recorded inbound frame through the receive path, as the
+    // event loop would. For replaying captures; not thread-safe against
+    // a running event loop.
+    void replayFrame(const char* data, size_t len);
+
+    // Event loop management; the policy is applied when the loop starts
+    void setThreadPolicy(const ThreadPolicy& policy);
     void startEventLoop();
     void stopEventLoop();
 
@@ -37,7 +88,9 @@ private:
     // Libwebsockets context and connection
     struct lws_context* context;
     struct lws* wsi;
+    struct lws* closingWsi;
     std::string serverUrl;
+    void closeConnection();
 
     // Connection state
     std::atomic<bool> connected;
@@ -48,6 +101,33 @@ private:
     std::queue<SignalingMessage> incomingMessages;
     MessageCallback messageCallback;
 
+    // Outbound frames (with LWS_PRE headroom), written by the event loop
+    std::mutex txMutex;
+    std::deque<QueuedFrame, TaggedAllocator<QueuedFrame, MemoryTag::QUEUES>> txQueue;
+    bool queueFrame(const std::string& serialized);
+    void onWritable();
+
+    // Link sampling and write batching, owned by the event loop; the
+    // published snapshot is read from other threads
+    mutable std::mutex linkMutex;
+    LinkStats linkStats;
+    std::chrono::steady_clock::time_point nextLinkSample;
+    std::chrono::steady_clock::time_point chokedSince;
+    std::chrono::steady_clock::duration chokedTotal;
+    bool choked;
+    uint32_t chokes;
+    uint32_t chokesAtSample;
+    size_t writeBatch;
+    void sampleLink();
+    void clearLinkStats();
+
+    // Timers serviced by the event loop, and the optional reliability layer
+    TimerWheel timers;
+    std::unique_ptr<ReliableChannel> reliability;
+
+    // Optional frame capture, written by the event loop
+    std::unique_ptr<SignalingCapture> capture;
+
     // Internal callback for libwebsockets
     static int callback_signaling(
         struct lws* wsi,
@@ -57,14 +137,19 @@ private:
         size_t len
     );
 
-    // Websocket frame processing
-    void processIncomingMessage(const char* data, size_t len);
+    // Websocket frame processing; fragments are reassembled in rxBuffer
+    // on the event loop before parsing
+    std::string rxBuffer;
+    void onReceive(struct lws* wsi, const char* data, size_t len);
+    void releaseRxBuffer();
+    void processIncomingMessage(char* data, size_t len);
 
     // Libwebsockets protocol definition
     static struct lws_protocols protocols[];
 
     // Event loop thread
     std::thread eventLoopThread;
+    ThreadPolicy eventLoopPolicy;
     void runEventLoop();
 };
 
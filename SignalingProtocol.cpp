@@ -1,5 +1,6 @@
 // src/SignalingProtocol.cpp
 #include "SignalingProtocol.h"
+#include "JsonCodec.h"
 #include <stdexcept>
 #include <cstring>
 
@@ -20,6 +21,7 @@ std::string signalingMessageTypeToString(SignalingMessageType type) {
     case SignalingMessageType::STREAM_INFO: return "STREAM_INFO";
     case SignalingMessageType::LOG: return "LOG";
     case SignalingMessageType::DIAGNOSTICS: return "DIAGNOSTICS";
+    case SignalingMessageType::ACK: return "ACK";
     default: return "UNKNOWN";
     }
 }
@@ -39,6 +41,7 @@ SignalingMessageType stringToSignalingMessageType(const std::string& typeStr) {
     if (typeStr == "STREAM_INFO") return SignalingMessageType::STREAM_INFO;
     if (typeStr == "LOG") return SignalingMessageType::LOG;
     if (typeStr == "DIAGNOSTICS") return SignalingMessageType::DIAGNOSTICS;
+    if (typeStr == "ACK") return SignalingMessageType::ACK;
 
     throw std::invalid_argument("Unknown message type: " + typeStr);
 }
@@ -126,8 +129,8 @@ std::string SignalingMessage::serialize() const {
         cJSON_AddStringToObject(root, "type",
             signalingMessageTypeToString(type).c_str());
 
-        // Add ID
-        cJSON_AddStringToObject(root, "id", id.c_str());
+        // Add ID (interned handles are materialised only here)
+        cJSON_AddStringToObject(root, "id", getId().c_str());
 
         // Add payload if exists
         if (payload) {
@@ -146,13 +149,7 @@ std::string SignalingMessage::serialize() const {
         }
 
         // Convert to string
-        char* jsonStr = cJSON_Print(root);
-        if (!jsonStr) {
-            throw std::runtime_error("Failed to convert JSON to string");
-        }
-
-        std::string result(jsonStr);
-        free(jsonStr);  // cJSON uses malloc, so use free
+        std::string result = jsonPrint(root);
         cJSON_Delete(root);
 
         return result;
@@ -164,13 +161,18 @@ std::string SignalingMessage::serialize() const {
     }
 }
 
-// Deserialization Method
+// Deserialization Methods
 SignalingMessage SignalingMessage::deserialize(const std::string& jsonStr) {
+    std::string copy(jsonStr);
+    return deserializeInPlace(&copy[0], copy.size());
+}
+
+SignalingMessage SignalingMessage::deserializeInPlace(char* data, size_t length) {
     // Parse JSON string
-    cJSON* root = cJSON_Parse(jsonStr.c_str());
+    size_t errorOffset = 0;
+    cJSON* root = jsonParseInPlace(data, length, &errorOffset);
     if (!root) {
-        const char* error = cJSON_GetErrorPtr();
-        throw std::runtime_error(error ? error : "Failed to parse JSON");
+        throw std::runtime_error("Failed to parse JSON at offset " + std::to_string(errorOffset));
     }
 
     try {
@@ -191,10 +193,10 @@ SignalingMessage SignalingMessage::deserialize(const std::string& jsonStr) {
         }
         msg.setId(idJson->valuestring);
 
-        // Extract payload (optional)
-        cJSON* payloadJson = cJSON_GetObjectItemCaseSensitive(root, "payload");
+        // Extract payload (optional); detached from the tree, not copied
+        cJSON* payloadJson = cJSON_DetachItemFromObjectCaseSensitive(root, "payload");
         if (payloadJson) {
-            msg.setPayload(cJSON_Duplicate(payloadJson, 1));
+            msg.adoptPayload(payloadJson);
         }
 
         // Extract metadata (optional)
@@ -239,8 +241,19 @@ void SignalingMessage::setPayload(cJSON* newPayload) {
     payload = newPayload ? cJSON_Duplicate(newPayload, 1) : nullptr;
 }
 
-void SignalingMessage::addMetadata(const std::string& key, const std::string& value) {
-    metadata[key] = value;
+void SignalingMessage::adoptPayload(cJSON* newPayload) {
+    if (payload) {
+        cJSON_Delete(payload);
+    }
+    payload = newPayload;
+}
+
+void SignalingMessage::addMetadata(const std::string& key, std::string value) {
+    metadata[key] = std::move(value);
+}
+
+void SignalingMessage::removeMetadata(const std::string& key) {
+    metadata.erase(key);
 }
 
 // Getters
@@ -248,7 +261,7 @@ SignalingMessageType SignalingMessage::getType() const {
     return type;
 }
 
-std::string SignalingMessage::getId() const {
+const std::string& SignalingMessage::getId() const {
     return id;
 }
 
@@ -265,7 +278,7 @@ std::string SignalingMessage::getMetadata(const std::string& key) const {
 // Validation Method
 bool SignalingMessage::validate() const {
     // Basic validation: ID must not be empty
-    if (id.empty()) return false;
+    if (getId().empty()) return false;
 
     // Type-specific validations
     switch (type) {
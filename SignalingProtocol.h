@@ -0,0 +1,79 @@
+// include/SignalingProtocol.h
+#ifndef SIGNALING_PROTOCOL_H
+#define SIGNALING_PROTOCOL_H
+
+#include <string>
+#include <map>
+#include <cjson/cJSON.h>
+
+// Signaling message types exchanged with the server
+enum class SignalingMessageType {
+    REGISTER,
+    REQUEST,
+    RESPONSE,
+    OFFER,
+    ANSWER,
+    ICE,
+    HEARTBEAT,
+    ERROR,
+    DISCONNECT,
+    STATUS,
+    CONFIG_UPDATE,
+    STREAM_INFO,
+    LOG,
+    DIAGNOSTICS,
+    ACK
+};
+
+// Type conversion helpers
+std::string signalingMessageTypeToString(SignalingMessageType type);
+SignalingMessageType stringToSignalingMessageType(const std::string& typeStr);
+
+class SignalingMessage {
+public:
+    SignalingMessage();
+    SignalingMessage(SignalingMessageType msgType, const std::string& msgId);
+    ~SignalingMessage();
+
+    // Copy and move semantics (payload is deep-copied)
+    SignalingMessage(const SignalingMessage& other);
+    SignalingMessage& operator=(const SignalingMessage& other);
+    SignalingMessage(SignalingMessage&& other) noexcept;
+    SignalingMessage& operator=(SignalingMessage&& other) noexcept;
+
+    // Serialization
+    std::string serialize() const;
+    static SignalingMessage deserialize(const std::string& jsonStr);
+
+    // Parses without copying; data is left unspecified (see jsonParseInPlace)
+    static SignalingMessage deserializeInPlace(char* data, size_t length);
+
+    // Setters
+    void setType(SignalingMessageType newType);
+    void setId(const std::string& newId);
+    void setPayload(cJSON* newPayload);
+    void addMetadata(const std::string& key, std::string value);
+    void removeMetadata(const std::string& key);
+
+    // Getters
+    SignalingMessageType getType() const;
+    const std::string& getId() const;
+    cJSON* getPayload() const;
+    std::string getMetadata(const std::string& key) const;
+
+    // Validation
+    bool validate() const;
+
+private:
+    SignalingMessageType type;
+
+    std::string id;
+
+    cJSON* payload;
+    std::map<std::string, std::string> metadata;
+
+    // Take ownership of a payload without copying it
+    void adoptPayload(cJSON* newPayload);
+};
+
+#endif // SIGNALING_PROTOCOL_H
\ No newline at end of file
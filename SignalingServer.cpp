@@ -0,0 +1,542 @@
+// src/SignalingServer.cpp
+#include "SignalingServer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+    // Bound per-peer backlog so one slow viewer cannot pin server memory
+    const size_t kMaxQueuedFrames = 256;
+
+    // Reassembly capacity an idle connection may keep between messages
+    const size_t kRxBufferKeep = 1024;
+
+    // Build an outbound frame with LWS_PRE bytes of headroom so the
+    // service thread can hand it to lws_write without another copy
+    QueuedFrame makeFrame(const std::string& serialized) {
+        QueuedFrame frame(LWS_PRE, '\0');
+        frame.append(serialized.data(), serialized.size());
+        return frame;
+    }
+
+    // seq/ack number one connection; a forwarded message must not carry
+    // the sender's into the receiver's sequence space
+    void stripHopMetadata(SignalingMessage& message) {
+        message.removeMetadata("seq");
+        message.removeMetadata("ack");
+    }
+}
+
+// Constructor and Destructor
+SignalingServer::SignalingServer(const SignalingServerConfig& serverConfig)
+    : config(serverConfig),
+    context(nullptr),
+    running(false),
+    nextViewerId(1),
+    messageIds("server"),
+    devices(serverConfig.routingShards),
+    viewers(serverConfig.routingShards) {
+
+    if (config.serviceThreads == 0) {
+        config.serviceThreads = std::thread::hardware_concurrency();
+        if (config.serviceThreads == 0) {
+            config.serviceThreads = 1;
+        }
+    }
+
+    wakeLists.reset(new WakeList[config.serviceThreads]);
+
+    MemoryAccounting::setBudget(MemoryTag::QUEUES, config.queueMemoryBudget);
+    MemoryAccounting::setBudget(MemoryTag::JSON, config.jsonMemoryBudget);
+
+    // Initialize libwebsockets context with one service thread per core
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.port = config.port;
+    info.iface = NULL;
+    info.protocols = protocols;
+    info.gid = -1;
+    info.uid = -1;
+    info.user = this;
+    info.count_threads = config.serviceThreads;
+    info.fd_limit_per_thread = 1 + config.maxConnections / config.serviceThreads;
+    info.options = LWS_SERVER_OPTION_VALIDATE_UTF8;
+
+    // TCP keepalive lets the kernel reap devices that vanished silently
+    info.ka_time = 60;
+    info.ka_probes = 3;
+    info.ka_interval = 10;
+
+    context = lws_create_context(&info);
+    if (!context) {
+        throw std::runtime_error("Failed to create libwebsockets server context");
+    }
+}
+
+SignalingServer::~SignalingServer() {
+    stop();
+
+    if (context) {
+        lws_context_destroy(context);
+        context = nullptr;
+    }
+}
+
+// Service Thread Management
+void SignalingServer::start() {
+    if (running) {
+        return;
+    }
+
+    running = true;
+    for (unsigned int tsi = 0; tsi < config.serviceThreads; tsi++) {
+        serviceThreads.emplace_back(&SignalingServer::runServiceThread, this, tsi);
+    }
+}
+
+void SignalingServer::stop() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+    lws_cancel_service(context);
+
+    for (auto& thread : serviceThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    serviceThreads.clear();
+}
+
+bool SignalingServer::isRunning() const {
+    return running;
+}
+
+size_t SignalingServer::deviceCount() const {
+    return devices.size();
+}
+
+size_t SignalingServer::viewerCount() const {
+    return viewers.size();
+}
+
+void SignalingServer::runServiceThread(int tsi) {
+    while (running) {
+        if (lws_service_tsi(context, 1000, tsi) < 0) {
+            break;
+        }
+    }
+}
+
+// Connection Lifecycle
+void SignalingServer::onConnect(struct lws* wsi, PerSessionData* pss) {
+    pss->peer = new Peer(wsi, lws_get_tsi(wsi));
+
+    // Unregistered sockets get one idle period to send REGISTER
+    lws_set_timeout(wsi, PENDING_TIMEOUT_USER_OK, config.idleTimeoutSecs);
+}
+
+void SignalingServer::onReceive(struct lws* wsi, PerSessionData* pss, const char* data, size_t len) {
+    Peer* peer = pss->peer;
+
+    if (peer->rxBuffer.size() + len > config.maxMessageSize) {
+        LOG_WARN("Dropping oversized message from %s", peer->peerId);
+        releaseRxBuffer(peer);
+        return;
+    }
+
+    // Reassemble fragmented frames before parsing
+    peer->rxBuffer.append(data, len);
+    if (!lws_is_final_fragment(wsi) || lws_remaining_packet_payload(wsi) > 0) {
+        return;
+    }
+
+    // Any complete frame counts as liveness
+    lws_set_timeout(wsi, PENDING_TIMEOUT_USER_OK, config.idleTimeoutSecs);
+
+    // Under JSON pressure, shed input before parsing adds to it; reliable
+    // senders retransmit once we recover
+    if (!MemoryAccounting::withinBudget(MemoryTag::JSON, peer->rxBuffer.size())) {
+        LOG_WARN("JSON memory budget exceeded, dropping message from %s", peer->peerId);
+        releaseRxBuffer(peer);
+        return;
+    }
+
+    try {
+        // Parsed in place; the buffer is released right after
+        SignalingMessage message = SignalingMessage::deserializeInPlace(
+            &peer->rxBuffer[0], peer->rxBuffer.size());
+        releaseRxBuffer(peer);
+
+        // Retransmissions after a flaky uplink are dropped here. Sequenced
+        // frames are deduplicated (and acked) by seq alone; ids are only
+        // meaningful from peers that said they generate them, since a
+        // plain id like "camera1" is valid base32 too.
+        if (!message.getMetadata("seq").empty()) {
+            if (!acceptSequenced(peer, message)) {
+                return;
+            }
+        }
+        else if (peer->generatedIds && !peer->rxFilter.accept(message.getId())) {
+            return;
+        }
+
+        // Keeps routed-to peers alive while we queue onto them
+        EpochGuard guard;
+        handleMessage(peer, message);
+    }
+    catch (const std::exception& e) {
+        releaseRxBuffer(peer);
+        LOG_WARN("Message deserialization error: %s", e.what());
+    }
+}
+
+int SignalingServer::onWritable(struct lws* wsi, PerSessionData* pss) {
+    Peer* peer = pss->peer;
+
+    QueuedFrame frame;
+    bool more = false;
+    {
+        std::lock_guard<std::mutex> lock(peer->txMutex);
+        if (peer->txQueue.empty()) {
+            return 0;
+        }
+        frame = std::move(peer->txQueue.front());
+        peer->txQueue.pop_front();
+        peer->txQueued--;
+        more = !peer->txQueue.empty();
+    }
+
+    size_t payloadLen = frame.size() - LWS_PRE;
+    int n = lws_write(wsi,
+        reinterpret_cast<unsigned char*>(&frame[LWS_PRE]),
+        payloadLen, LWS_WRITE_TEXT);
+
+    // A partial frame corrupts the stream; drop the connection so the
+    // peer reconnects and retransmits
+    if (n < static_cast<int>(payloadLen)) {
+        LOG_ERROR("Failed to send complete message to %s, closing", peer->peerId);
+        return -1;
+    }
+
+    if (more) {
+        lws_callback_on_writable(wsi);
+    }
+    return 0;
+}
+
+void SignalingServer::onClose(PerSessionData* pss) {
+    Peer* peer = pss->peer;
+    pss->peer = nullptr;
+
+    if (!peer) {
+        return;
+    }
+
+    // Block concurrent enqueue() calls from touching the dying wsi
+    {
+        std::lock_guard<std::mutex> lock(peer->txMutex);
+        peer->closed = true;
+        peer->txQueue.clear();
+        peer->txQueued = 0;
+    }
+
+    if (peer->role == PeerRole::DEVICE) {
+        devices.remove(peer->peerId, peer);
+    }
+    else if (peer->role == PeerRole::VIEWER) {
+        viewers.remove(peer->peerId, peer);
+
+        // Devices hold capacity for a viewer until they hear it is gone
+        EpochGuard guard;
+        for (const std::string& deviceId : peer->addressedDevices) {
+            Peer* device = devices.find(deviceId);
+            if (!device) {
+                continue;
+            }
+            SignalingMessage bye(SignalingMessageType::DISCONNECT, messageIds.next().str());
+            bye.addMetadata("viewer_id", peer->peerId);
+            bye.addMetadata("device_id", deviceId);
+            enqueue(device, makeFrame(bye.serialize()));
+        }
+    }
+
+    // Wake lists are only drained on this thread, so scrub ours now
+    {
+        std::lock_guard<std::mutex> lock(wakeLists[peer->tsi].mutex);
+        std::vector<Peer*>& pending = wakeLists[peer->tsi].peers;
+        pending.erase(std::remove(pending.begin(), pending.end(), peer), pending.end());
+    }
+
+    // Other service threads may still hold it from a lookup
+    EpochManager::instance().retire(peer);
+}
+
+void SignalingServer::releaseRxBuffer(Peer* peer) {
+    // Return large reassembly buffers instead of pinning them per device
+    if (peer->rxBuffer.capacity() > kRxBufferKeep) {
+        std::string().swap(peer->rxBuffer);
+    }
+    else {
+        peer->rxBuffer.clear();
+    }
+}
+
+void SignalingServer::onWakeup(int tsi) {
+    std::vector<Peer*> pending;
+    {
+        std::lock_guard<std::mutex> lock(wakeLists[tsi].mutex);
+        pending.swap(wakeLists[tsi].peers);
+    }
+
+    // Running on the owning service thread, so the wsi cannot close under us
+    for (Peer* peer : pending) {
+        if (!peer->closed) {
+            lws_callback_on_writable(peer->wsi);
+        }
+    }
+}
+
+void SignalingServer::enqueue(Peer* peer, QueuedFrame frame) {
+    std::lock_guard<std::mutex> lock(peer->txMutex);
+    if (peer->closed) {
+        return;
+    }
+
+    if (peer->txQueued >= kMaxQueuedFrames) {
+        LOG_WARN("Send queue full for %s, dropping message", peer->peerId);
+        return;
+    }
+
+    // The frame is already charged; this bounds the total across peers
+    if (!MemoryAccounting::withinBudget(MemoryTag::QUEUES)) {
+        LOG_WARN("Queue memory budget exceeded, dropping message for %s", peer->peerId);
+        return;
+    }
+
+    bool wasEmpty = peer->txQueue.empty();
+    peer->txQueue.push_back(std::move(frame));
+    peer->txQueued++;
+
+    if (wasEmpty) {
+        {
+            std::lock_guard<std::mutex> wakeLock(wakeLists[peer->tsi].mutex);
+            wakeLists[peer->tsi].peers.push_back(peer);
+        }
+        // Safe while txMutex is held: onClose cannot finish meanwhile
+        lws_cancel_service_pt(peer->wsi);
+    }
+}
+
+// Message Routing
+void SignalingServer::handleMessage(Peer* peer, SignalingMessage& message) {
+    if (!message.validate()) {
+        sendError(peer, message.getId(), "invalid message");
+        return;
+    }
+
+    switch (message.getType()) {
+    case SignalingMessageType::REGISTER:
+        handleRegister(peer, message);
+        return;
+
+    case SignalingMessageType::HEARTBEAT:
+        // Liveness was already refreshed on receive
+        return;
+
+    case SignalingMessageType::ACK:
+        // The server does not sequence its own messages
+        return;
+
+    default:
+        break;
+    }
+
+    switch (peer->role) {
+    case PeerRole::VIEWER:
+        routeToDevice(peer, message);
+        break;
+
+    case PeerRole::DEVICE:
+        routeToViewer(peer, message);
+        break;
+
+    default:
+        sendError(peer, message.getId(), "not registered");
+        break;
+    }
+}
+
+void SignalingServer::handleRegister(Peer* peer, const SignalingMessage& message) {
+    if (peer->role != PeerRole::UNREGISTERED) {
+        sendError(peer, message.getId(), "already registered");
+        return;
+    }
+
+    cJSON* payload = message.getPayload();
+    cJSON* deviceType = cJSON_GetObjectItemCaseSensitive(payload, "device_type");
+    cJSON* deviceId = cJSON_GetObjectItemCaseSensitive(payload, "device_id");
+
+    bool isViewer = cJSON_IsString(deviceType) &&
+        strcmp(deviceType->valuestring, "viewer") == 0;
+    peer->generatedIds = message.getMetadata("id_format") == "base32";
+
+    if (isViewer) {
+        // Viewers are addressed by a server-assigned id
+        peer->role = PeerRole::VIEWER;
+        peer->peerId = "viewer-" + std::to_string(nextViewerId++);
+        viewers.insert(peer->peerId, peer);
+    }
+    else {
+        // Devices register under their own id
+        peer->role = PeerRole::DEVICE;
+        peer->peerId = cJSON_IsString(deviceId) ? deviceId->valuestring : message.getId();
+        devices.insert(peer->peerId, peer);
+    }
+
+    cJSON_Delete(payload);
+
+    SignalingMessage ack(SignalingMessageType::RESPONSE, messageIds.next().str());
+    ack.addMetadata("request_id", message.getId());
+    ack.addMetadata(isViewer ? "viewer_id" : "device_id", peer->peerId);
+
+    cJSON* ackPayload = cJSON_CreateObject();
+    cJSON_AddStringToObject(ackPayload, "status", "registered");
+    ack.setPayload(ackPayload);
+    cJSON_Delete(ackPayload);
+
+    enqueue(peer, makeFrame(ack.serialize()));
+}
+
+void SignalingServer::routeToDevice(Peer* viewer, SignalingMessage& message) {
+    std::string deviceId = message.getMetadata("device_id");
+    Peer* device = deviceId.empty() ? nullptr : devices.find(deviceId);
+
+    if (!device) {
+        sendError(viewer, message.getId(), "device offline");
+        return;
+    }
+
+    // Stamp the sender so the device can address its reply
+    message.addMetadata("viewer_id", viewer->peerId);
+    viewer->addressedDevices.insert(deviceId);
+    stripHopMetadata(message);
+    enqueue(device, makeFrame(message.serialize()));
+}
+
+void SignalingServer::routeToViewer(Peer* device, SignalingMessage& message) {
+    std::string viewerId = message.getMetadata("viewer_id");
+    if (viewerId.empty()) {
+        // Device-level traffic (STATUS, LOG, ...) with no viewer attached;
+        // hang reports are kept in the server log for the operator
+        if (message.getType() == SignalingMessageType::DIAGNOSTICS) {
+            cJSON* payload = message.getPayload();
+            cJSON* kind = cJSON_GetObjectItemCaseSensitive(payload, "kind");
+            cJSON* data = cJSON_GetObjectItemCaseSensitive(payload, "data");
+            if (cJSON_IsString(kind) && strcmp(kind->valuestring, "hang") == 0 && cJSON_IsString(data)) {
+                LOG_WARN("Device %s recovered from a hang:", device->peerId);
+                Logger::instance().logLines(LogLevel::WARN, data->valuestring);
+            }
+            cJSON_Delete(payload);
+        }
+        return;
+    }
+
+    Peer* viewer = viewers.find(viewerId);
+    if (!viewer) {
+        // Viewer left before the device answered
+        return;
+    }
+
+    message.addMetadata("device_id", device->peerId);
+    stripHopMetadata(message);
+    enqueue(viewer, makeFrame(message.serialize()));
+}
+
+void SignalingServer::sendError(Peer* peer, const std::string& requestId, const std::string& reason) {
+    SignalingMessage error(SignalingMessageType::ERROR, messageIds.next().str());
+    error.addMetadata("request_id", requestId);
+
+    cJSON* payload = cJSON_CreateObject();
+    cJSON_AddStringToObject(payload, "message", reason.c_str());
+    error.setPayload(payload);
+    cJSON_Delete(payload);
+
+    enqueue(peer, makeFrame(error.serialize()));
+}
+
+bool SignalingServer::acceptSequenced(Peer* peer, const SignalingMessage& message) {
+    std::string seqStr = message.getMetadata("seq");
+    if (seqStr.empty()) {
+        return true;
+    }
+
+    // Ack every sequenced message, duplicates included: the sender is
+    // retransmitting because an earlier ack went missing. Sequence numbers
+    // start at 1 on each connection, as does rxSequence.
+    ReceiveWindow::Result result = peer->rxSequence.accept(strtoull(seqStr.c_str(), nullptr, 10));
+    if (result == ReceiveWindow::Result::FULL) {
+        LOG_WARN("Receive window full, dropping seq %s from %s", seqStr, peer->peerId);
+    }
+
+    SignalingMessage ack(SignalingMessageType::ACK, messageIds.next().str());
+    ack.addMetadata("ack", std::to_string(peer->rxSequence.cumulative()));
+    enqueue(peer, makeFrame(ack.serialize()));
+
+    return result == ReceiveWindow::Result::FRESH;
+}
+
+// Libwebsockets protocol callback
+int SignalingServer::callback_signaling(
+    struct lws* wsi,
+    enum lws_callback_reasons reason,
+    void* user,
+    void* in,
+    size_t len
+) {
+    SignalingServer* server = static_cast<SignalingServer*>(
+        lws_context_user(lws_get_context(wsi))
+        );
+    PerSessionData* pss = static_cast<PerSessionData*>(user);
+
+    switch (reason) {
+    case LWS_CALLBACK_ESTABLISHED:
+        server->onConnect(wsi, pss);
+        break;
+
+    case LWS_CALLBACK_RECEIVE:
+        server->onReceive(wsi, pss, static_cast<const char*>(in), len);
+        break;
+
+    case LWS_CALLBACK_SERVER_WRITEABLE:
+        return server->onWritable(wsi, pss);
+
+    case LWS_CALLBACK_CLOSED:
+        server->onClose(pss);
+        break;
+
+    case LWS_CALLBACK_EVENT_WAIT_CANCELLED:
+        server->onWakeup(lws_get_tsi(wsi));
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+// Static protocol definition
+struct lws_protocols SignalingServer::protocols[] = {
+    {
+        "signaling",                          // Protocol name
+        SignalingServer::callback_signaling,  // Callback function
+        sizeof(SignalingServer::PerSessionData), // Per-session data size
+        4096,                                 // Receive buffer size
+    },
+    { NULL, NULL, 0, 0 }     // Terminating null protocol
+};
\ No newline at end of file
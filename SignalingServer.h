@@ -0,0 +1,136 @@
+// include/SignalingServer.h
+#ifndef SIGNALING_SERVER_H
+#define SIGNALING_SERVER_H
+
+#include <libwebsockets.h>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <list>
+#include <set>
+#include <vector>
+#include <memory>
+#include <thread>
+
+#include "SignalingProtocol.h"
+#include "PeerRegistry.h"
+#include "MessageId.h"
+#include "ReliableChannel.h"
+#include "MemoryAccounting.h"
+
+// Server-side tuning knobs
+struct SignalingServerConfig {
+    int port = 8080;
+    unsigned int serviceThreads = 0;        // 0 = one per core
+    unsigned int maxConnections = 131072;   // Sized for 100k idle devices
+    unsigned int routingShards = 64;        // Power of two
+    int idleTimeoutSecs = 95;               // ~3 missed heartbeats
+    size_t maxMessageSize = 64 * 1024;      // Large SDP offers fit comfortably
+    size_t queueMemoryBudget = 0;           // Bytes across all peers; 0 = unlimited
+    size_t jsonMemoryBudget = 0;            // Bytes of live cJSON; 0 = unlimited
+};
+
+class SignalingServer {
+public:
+    explicit SignalingServer(const SignalingServerConfig& config);
+    ~SignalingServer();
+
+    // Service thread management
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Counters
+    size_t deviceCount() const;
+    size_t viewerCount() const;
+
+private:
+    enum class PeerRole {
+        UNREGISTERED,
+        DEVICE,
+        VIEWER
+    };
+
+    // One connected websocket; outbound frames may be queued from any
+    // service thread and are drained by the thread owning the wsi.
+    // Freed through EpochManager once closed and unregistered.
+    struct Peer {
+        struct lws* wsi;
+        int tsi;
+        PeerRole role;
+        std::string peerId;
+        std::string rxBuffer;
+        DuplicateFilter rxFilter;
+        ReceiveWindow rxSequence;
+        bool generatedIds;      // Registered with id_format=base32
+
+        // Devices a viewer has addressed, told when it goes away; only
+        // touched on the peer's service thread
+        std::set<std::string> addressedDevices;
+
+        // std::list stays allocation-free while idle, unlike std::deque
+        std::mutex txMutex;
+        std::list<QueuedFrame, TaggedAllocator<QueuedFrame, MemoryTag::QUEUES>> txQueue;
+        size_t txQueued;
+        std::atomic<bool> closed;
+
+        Peer(struct lws* w, int t)
+            : wsi(w), tsi(t), role(PeerRole::UNREGISTERED), generatedIds(false),
+            txQueued(0), closed(false) {}
+    };
+
+    // Per-service-thread list of peers with frames waiting to be written
+    struct WakeList {
+        std::mutex mutex;
+        std::vector<Peer*> peers;
+    };
+
+    // Per-session storage handed out by libwebsockets
+    struct PerSessionData {
+        Peer* peer;
+    };
+
+    SignalingServerConfig config;
+    struct lws_context* context;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> nextViewerId;
+    MessageIdGenerator messageIds;
+
+    PeerRegistry<Peer> devices;
+    PeerRegistry<Peer> viewers;
+    std::unique_ptr<WakeList[]> wakeLists;
+    std::vector<std::thread> serviceThreads;
+
+    // Connection lifecycle
+    void onConnect(struct lws* wsi, PerSessionData* pss);
+    void onReceive(struct lws* wsi, PerSessionData* pss, const char* data, size_t len);
+    int onWritable(struct lws* wsi, PerSessionData* pss);
+    void onClose(PerSessionData* pss);
+    void onWakeup(int tsi);
+    void releaseRxBuffer(Peer* peer);
+
+    // Message routing
+    void handleMessage(Peer* peer, SignalingMessage& message);
+    void handleRegister(Peer* peer, const SignalingMessage& message);
+    void routeToDevice(Peer* viewer, SignalingMessage& message);
+    void routeToViewer(Peer* device, SignalingMessage& message);
+    void sendError(Peer* peer, const std::string& requestId, const std::string& reason);
+    bool acceptSequenced(Peer* peer, const SignalingMessage& message);
+
+    // Queue a frame on a peer and wake its service thread
+    void enqueue(Peer* peer, QueuedFrame frame);
+
+    static int callback_signaling(
+        struct lws* wsi,
+        enum lws_callback_reasons reason,
+        void* user,
+        void* in,
+        size_t len
+    );
+
+    static struct lws_protocols protocols[];
+
+    void runServiceThread(int tsi);
+};
+
+#endif // SIGNALING_SERVER_H
\ No newline at end of file
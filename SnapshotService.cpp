@@ -0,0 +1,238 @@
+// src/SnapshotService.cpp
+#include "SnapshotService.h"
+#include "Logger.h"
+#include "Base64.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <turbojpeg.h>
+
+namespace {
+    // Keeps a snapshot RESPONSE under the server's 64 kB message limit
+    const size_t kMaxJpegBytes = 44 * 1024;
+    const int kQualityStep = 15;
+    const int kMinQuality = 30;
+    const int kMinWidth = 160;          // Smallest still worth sending
+
+    int64_t steadyMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int64_t wallClockMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Box-average one plane by an integer factor
+    void downscalePlane(const uint8_t* src, int srcWidth,
+        uint8_t* dst, int dstWidth, int dstHeight, int factor) {
+        const int area = factor * factor;
+        for (int y = 0; y < dstHeight; y++) {
+            for (int x = 0; x < dstWidth; x++) {
+                unsigned int sum = 0;
+                for (int dy = 0; dy < factor; dy++) {
+                    const uint8_t* row = src + (y * factor + dy) * srcWidth + x * factor;
+                    for (int dx = 0; dx < factor; dx++) {
+                        sum += row[dx];
+                    }
+                }
+                dst[y * dstWidth + x] = static_cast<uint8_t>((sum + area / 2) / area);
+            }
+        }
+    }
+}
+
+// Constructor and Destructor
+SnapshotService::SnapshotService(const DeviceConfig::SnapshotSettings& snapshotSettings)
+    : settings(snapshotSettings),
+    cachedAtMs(0),
+    running(false) {
+}
+
+SnapshotService::~SnapshotService() {
+    stop();
+}
+
+// Encoder Thread
+void SnapshotService::start(const ThreadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    encoderThread = std::thread(&SnapshotService::runEncoder, this, policy);
+}
+
+void SnapshotService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wakeCondition.notify_one();
+    if (encoderThread.joinable()) {
+        encoderThread.join();
+    }
+}
+
+void SnapshotService::request(SnapshotCallback callback) {
+    std::shared_ptr<const Snapshot> fresh;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cached && steadyMs() - cachedAtMs < settings.cacheSecs * 1000) {
+            fresh = cached;
+        }
+        else {
+            // Joins the encode in flight, or triggers the next one
+            waiting.push_back(std::move(callback));
+        }
+    }
+
+    if (fresh) {
+        callback(fresh);
+    }
+    else {
+        wakeCondition.notify_one();
+    }
+}
+
+void SnapshotService::runEncoder(ThreadPolicy policy) {
+    policy.apply();
+
+    tjhandle compressor = tjInitCompress();
+    if (!compressor) {
+        LOG_ERROR("Snapshot: could not create JPEG compressor");
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [this]() { return !running || !waiting.empty(); });
+        if (!running) {
+            break;
+        }
+
+        // Everyone who asked so far shares this encode
+        std::vector<SnapshotCallback> callbacks;
+        callbacks.swap(waiting);
+        lock.unlock();
+
+        std::shared_ptr<const Snapshot> snapshot = capture(compressor);
+
+        lock.lock();
+        if (snapshot->error.empty()) {
+            cached = snapshot;
+            cachedAtMs = steadyMs();
+        }
+        lock.unlock();
+
+        for (auto& callback : callbacks) {
+            callback(snapshot);
+        }
+        lock.lock();
+    }
+
+    // Anyone still waiting gets an answer rather than silence
+    std::vector<SnapshotCallback> callbacks;
+    callbacks.swap(waiting);
+    lock.unlock();
+
+    std::shared_ptr<Snapshot> stopped = std::make_shared<Snapshot>();
+    stopped->error = "snapshot service stopped";
+    for (auto& callback : callbacks) {
+        callback(stopped);
+    }
+
+    if (compressor) {
+        tjDestroy(compressor);
+    }
+}
+
+std::shared_ptr<const Snapshot> SnapshotService::capture(void* compressor) {
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+
+    if (!compressor) {
+        snapshot->error = "jpeg encoder unavailable";
+        return snapshot;
+    }
+
+    // Latest raw I420 frame, replaced atomically (rename) by the pipeline
+    const int width = settings.width;
+    const int height = settings.height;
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    const size_t frameSize = lumaSize + 2 * (lumaSize / 4);
+
+    std::vector<uint8_t> frame(frameSize);
+    FILE* file = fopen(settings.source.c_str(), "rb");
+    if (!file) {
+        snapshot->error = "no frame available";
+        return snapshot;
+    }
+    size_t got = fread(frame.data(), 1, frameSize, file);
+    fclose(file);
+    if (got != frameSize) {
+        snapshot->error = "incomplete frame";
+        return snapshot;
+    }
+    snapshot->capturedAtMs = wallClockMs();
+
+    // Integer box downscale keeps chroma aligned with luma
+    int factor = 1;
+    while (width / factor > settings.maxWidth) {
+        factor++;
+    }
+
+    // Step quality down until the image fits in one signaling message;
+    // if even the lowest quality does not fit, shrink the image further
+    std::vector<uint8_t> scaled;
+    const int firstFactor = factor;
+    for (; factor == firstFactor || width / factor >= kMinWidth; factor++) {
+        const int outWidth = (width / factor) & ~1;
+        const int outHeight = (height / factor) & ~1;
+
+        const uint8_t* planes[3] = {
+            frame.data(), frame.data() + lumaSize, frame.data() + lumaSize + lumaSize / 4
+        };
+        if (factor > 1) {
+            size_t outLuma = static_cast<size_t>(outWidth) * outHeight;
+            scaled.resize(outLuma + 2 * (outLuma / 4));
+            uint8_t* outPlanes[3] = {
+                scaled.data(), scaled.data() + outLuma, scaled.data() + outLuma + outLuma / 4
+            };
+
+            downscalePlane(planes[0], width, outPlanes[0], outWidth, outHeight, factor);
+            for (int p = 1; p < 3; p++) {
+                downscalePlane(planes[p], width / 2, outPlanes[p], outWidth / 2, outHeight / 2, factor);
+            }
+            for (int p = 0; p < 3; p++) {
+                planes[p] = outPlanes[p];
+            }
+        }
+
+        const int stride = factor > 1 ? outWidth : width;
+        const int strides[3] = { stride, stride / 2, stride / 2 };
+
+        for (int quality = std::max(settings.quality, kMinQuality); quality >= kMinQuality; quality -= kQualityStep) {
+            unsigned char* jpeg = nullptr;
+            unsigned long jpegSize = 0;
+            if (tjCompressFromYUVPlanes(static_cast<tjhandle>(compressor), planes, outWidth, strides,
+                outHeight, TJSAMP_420, &jpeg, &jpegSize, quality, TJFLAG_FASTDCT) != 0) {
+                LOG_WARN("Snapshot: JPEG encode failed: %s", tjGetErrorStr2(static_cast<tjhandle>(compressor)));
+                tjFree(jpeg);
+                snapshot->error = "jpeg encode failed";
+                return snapshot;
+            }
+
+            if (jpegSize <= kMaxJpegBytes) {
+                snapshot->jpegBase64 = base64Encode(jpeg, jpegSize);
+                snapshot->width = outWidth;
+                snapshot->height = outHeight;
+                tjFree(jpeg);
+                return snapshot;
+            }
+            tjFree(jpeg);
+        }
+    }
+
+    snapshot->error = "snapshot too large";
+    return snapshot;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+// include/SnapshotService.h
+#ifndef SNAPSHOT_SERVICE_H
+#define SNAPSHOT_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+#include "DeviceConfig.h"
+#include "ThreadPolicy.h"
+
+// One encoded still image
+struct Snapshot {
+    std::string jpegBase64;
+    int width = 0;
+    int height = 0;
+    int64_t capturedAtMs = 0;       // Wall clock
+    std::string error;              // Set when no image could be produced
+};
+
+// JPEG snapshots for dashboards, without starting a stream.
+//
+// The capture pipeline keeps the latest raw I420 frame in a file; on
+// demand it is box-downscaled to at most maxWidth and compressed with
+// libjpeg-turbo straight from the YUV planes (SIMD DCT, no colour
+// conversion). Results are cached for cacheSecs, and requests arriving
+// while an encode is running wait for that encode rather than starting
+// another, so any number of concurrent polls costs at most one encode.
+class SnapshotService {
+public:
+    typedef std::function<void(std::shared_ptr<const Snapshot>)> SnapshotCallback;
+
+    explicit SnapshotService(const DeviceConfig::SnapshotSettings& settings);
+    ~SnapshotService();
+
+    // Encoder thread
+    void start(const ThreadPolicy& policy);
+    void stop();
+
+    // Calls back at once with a fresh cached snapshot, otherwise from the
+    // encoder thread when the next encode finishes
+    void request(SnapshotCallback callback);
+
+private:
+    DeviceConfig::SnapshotSettings settings;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::vector<SnapshotCallback> waiting;
+    std::shared_ptr<const Snapshot> cached;
+    int64_t cachedAtMs;
+    bool running;
+    std::thread encoderThread;
+
+    void runEncoder(ThreadPolicy policy);
+    std::shared_ptr<const Snapshot> capture(void* compressor);
+};
+
+#endif // SNAPSHOT_SERVICE_H
\ No newline at end of file
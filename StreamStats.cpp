@@ -0,0 +1,141 @@
+// src/StreamStats.cpp
+#include "StreamStats.h"
+#include <cmath>
+
+namespace {
+    // Weight of the newest interval in the smoothed rates
+    const double kSmoothing = 0.3;
+
+    bool relativeChange(double previous, double current, double threshold) {
+        if (previous <= 0.0) {
+            return current > 0.0;
+        }
+        return std::fabs(current - previous) / previous > threshold;
+    }
+}
+
+cJSON* StreamInfo::toJson() const {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "codec", codec.c_str());
+    cJSON_AddNumberToObject(json, "width", width);
+    cJSON_AddNumberToObject(json, "height", height);
+    if (measured) {
+        cJSON_AddNumberToObject(json, "fps", std::round(fps * 10.0) / 10.0);
+        cJSON_AddNumberToObject(json, "bitrate_kbps", std::round(bitrateKbps));
+    }
+    cJSON_AddNumberToObject(json, "gop", gop);
+    cJSON_AddNumberToObject(json, "viewers", activeViewers);
+
+    cJSON* ingest = cJSON_AddObjectToObject(json, "ingest");
+    if (measured) {
+        cJSON_AddBoolToObject(ingest, "healthy", ingestHealthy);
+    }
+    cJSON_AddNumberToObject(ingest, "rtsp_reconnects", static_cast<double>(rtspReconnects));
+    cJSON_AddNumberToObject(ingest, "frame_drops", static_cast<double>(frameDrops));
+    return json;
+}
+
+// Constructor
+StreamStats::StreamStats(const DeviceConfig::StreamSettings& streamSettings)
+    : settings(streamSettings),
+    frames(0), bytes(0), keyframes(0), framesSinceKeyframe(0), lastGop(0),
+    drops(0), reconnects(0),
+    width(streamSettings.width), height(streamSettings.height), viewers(0),
+    lastSample(Clock::now()), lastFrames(0), lastBytes(0),
+    smoothedFps(0.0), smoothedKbps(0.0) {
+}
+
+// Media Path Hooks
+void StreamStats::recordFrame(size_t frameBytes, bool keyframe) {
+    frames.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(frameBytes, std::memory_order_relaxed);
+
+    if (keyframe) {
+        keyframes.fetch_add(1, std::memory_order_relaxed);
+        lastGop.store(framesSinceKeyframe.exchange(1, std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    }
+    else {
+        framesSinceKeyframe.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StreamStats::recordDrop() {
+    drops.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamStats::recordReconnect() {
+    reconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamStats::recordResolution(int newWidth, int newHeight) {
+    width.store(newWidth, std::memory_order_relaxed);
+    height.store(newHeight, std::memory_order_relaxed);
+}
+
+void StreamStats::viewerJoined() {
+    viewers.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamStats::viewerLeft() {
+    viewers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Sampling
+StreamInfo StreamStats::sample() {
+    std::lock_guard<std::mutex> lock(sampleMutex);
+
+    Clock::time_point now = Clock::now();
+    double seconds = std::chrono::duration<double>(now - lastSample).count();
+
+    uint64_t frameCount = frames.load(std::memory_order_relaxed);
+    uint64_t byteCount = bytes.load(std::memory_order_relaxed);
+
+    if (seconds > 0.0) {
+        double fps = (frameCount - lastFrames) / seconds;
+        double kbps = (byteCount - lastBytes) * 8.0 / 1000.0 / seconds;
+        smoothedFps += kSmoothing * (fps - smoothedFps);
+        smoothedKbps += kSmoothing * (kbps - smoothedKbps);
+    }
+
+    lastSample = now;
+    lastFrames = frameCount;
+    lastBytes = byteCount;
+
+    StreamInfo info;
+    info.codec = settings.codec;
+    info.width = width.load(std::memory_order_relaxed);
+    info.height = height.load(std::memory_order_relaxed);
+    info.fps = smoothedFps;
+    info.bitrateKbps = smoothedKbps;
+
+    // Measured GOP once two keyframes have been seen, configured before
+    uint64_t gop = lastGop.load(std::memory_order_relaxed);
+    info.gop = gop ? static_cast<int>(gop) : settings.gop;
+
+    info.activeViewers = viewers.load(std::memory_order_relaxed);
+    info.rtspReconnects = reconnects.load(std::memory_order_relaxed);
+    info.frameDrops = drops.load(std::memory_order_relaxed);
+
+    // Healthy: frames flowing at no less than half the configured rate.
+    // Without an ingest source feeding recordFrame() there is nothing to
+    // judge, which is not the same as unhealthy.
+    info.measured = frameCount > 0;
+    info.ingestHealthy = info.measured && smoothedFps >= settings.fps * 0.5;
+    return info;
+}
+
+bool StreamStats::significantChange(const StreamInfo& previous, const StreamInfo& current) {
+    return previous.codec != current.codec ||
+        previous.width != current.width ||
+        previous.height != current.height ||
+        previous.gop != current.gop ||
+        previous.activeViewers != current.activeViewers ||
+        previous.rtspReconnects != current.rtspReconnects ||
+        previous.measured != current.measured ||
+        previous.ingestHealthy != current.ingestHealthy ||
+        std::fabs(previous.fps - current.fps) >= 2.0 ||
+        relativeChange(previous.bitrateKbps, current.bitrateKbps, 0.2) ||
+        // Drops are noisy; report bursts rather than every frame
+        current.frameDrops >= previous.frameDrops + 25;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+// include/StreamStats.h
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cjson/cJSON.h>
+
+#include "DeviceConfig.h"
+
+// Point-in-time view of the stream, as published in STREAM_INFO
+struct StreamInfo {
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    double fps = 0.0;
+    double bitrateKbps = 0.0;
+    int gop = 0;
+    int activeViewers = 0;
+    uint64_t rtspReconnects = 0;
+    uint64_t frameDrops = 0;
+    bool ingestHealthy = false;
+
+    // False until the media path has recorded a frame; fps, bitrate and
+    // ingest health are left out of the JSON until then
+    bool measured = false;
+
+    cJSON* toJson() const;
+};
+
+// Live ingest/encoder counters.
+//
+// The record*() hooks are called from media threads and only touch
+// relaxed atomics. sample() turns the counters into rates and is called
+// periodically from the device's main loop.
+class StreamStats {
+public:
+    explicit StreamStats(const DeviceConfig::StreamSettings& settings);
+
+    // Media path hooks
+    void recordFrame(size_t bytes, bool keyframe);
+    void recordDrop();
+    void recordReconnect();
+    void recordResolution(int width, int height);
+    void viewerJoined();
+    void viewerLeft();
+
+    // Rates over the interval since the previous call
+    StreamInfo sample();
+
+    // Whether the change is large enough to be worth publishing
+    static bool significantChange(const StreamInfo& previous, const StreamInfo& current);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    DeviceConfig::StreamSettings settings;
+
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> keyframes;
+    std::atomic<uint64_t> framesSinceKeyframe;
+    std::atomic<uint64_t> lastGop;
+    std::atomic<uint64_t> drops;
+    std::atomic<uint64_t> reconnects;
+    std::atomic<int> width;
+    std::atomic<int> height;
+    std::atomic<int> viewers;
+
+    // Sampling state (main loop only)
+    std::mutex sampleMutex;
+    Clock::time_point lastSample;
+    uint64_t lastFrames;
+    uint64_t lastBytes;
+    double smoothedFps;
+    double smoothedKbps;
+};
+
+#endif // STREAM_STATS_H
\ No newline at end of file
@@ -0,0 +1,72 @@
+// src/ThreadPolicy.cpp
+#include "ThreadPolicy.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+bool ThreadPolicy::apply() const {
+    bool applied = true;
+
+    if (!name.empty()) {
+        // The kernel keeps 16 bytes including the terminator
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    }
+
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            LOG_WARN("Thread %s: could not set CPU affinity: %s", name, strerror(error));
+            applied = false;
+        }
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    int policy = SCHED_OTHER;
+    if (scheduling == SchedulingClass::FIFO) {
+        policy = SCHED_FIFO;
+        param.sched_priority = std::min(std::max(priority, sched_get_priority_min(SCHED_FIFO)),
+            sched_get_priority_max(SCHED_FIFO));
+    }
+
+    // Needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance for FIFO
+    int error = pthread_setschedparam(pthread_self(), policy, &param);
+    if (error != 0) {
+        LOG_WARN("Thread %s: could not set scheduling policy: %s", name, strerror(error));
+        applied = false;
+    }
+
+    if (scheduling == SchedulingClass::OTHER) {
+        // With a thread id, setpriority() renices just this thread
+        pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, tid, nice) != 0) {
+            LOG_WARN("Thread %s: could not set nice %d: %s", name, nice, strerror(errno));
+            applied = false;
+        }
+    }
+
+    return applied;
+}
+
+bool lockProcessMemory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        LOG_WARN("mlockall failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
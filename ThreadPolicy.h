@@ -0,0 +1,36 @@
+// include/ThreadPolicy.h
+#ifndef THREAD_POLICY_H
+#define THREAD_POLICY_H
+
+#include <string>
+#include <vector>
+
+enum class SchedulingClass {
+    OTHER,      // Time-shared, weighted by nice
+    FIFO        // Realtime; preempts every OTHER thread
+};
+
+// Name, CPU placement and scheduling for one thread role. A thread
+// applies its policy to itself as it starts: nice values and names are
+// per-thread on Linux and are easiest to set from inside the thread.
+struct ThreadPolicy {
+    std::string name;                   // At most 15 characters are kept
+    std::vector<int> cpus;              // Empty: any CPU
+    SchedulingClass scheduling = SchedulingClass::OTHER;
+    int priority = 0;                   // FIFO only: 1 (low) .. 99 (high)
+    int nice = 0;                       // OTHER only: -20 .. 19
+
+    ThreadPolicy() {}
+    explicit ThreadPolicy(const std::string& threadName, int niceValue = 0)
+        : name(threadName), nice(niceValue) {}
+
+    // Apply to the calling thread; false if any part was refused, in
+    // which case the rest is still applied
+    bool apply() const;
+};
+
+// Lock current and future pages in RAM so page faults never stall a
+// realtime thread
+bool lockProcessMemory();
+
+#endif // THREAD_POLICY_H
\ No newline at end of file
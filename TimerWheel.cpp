@@ -0,0 +1,94 @@
+// src/TimerWheel.cpp
+#include "TimerWheel.h"
+#include <stdexcept>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tickLength, size_t slotCount)
+    : tick(tickLength),
+    slots(slotCount ? slotCount : 1),
+    nextId(1),
+    cursor(0),
+    nextTick(Clock::now() + tickLength) {
+
+    if (tick.count() <= 0) {
+        throw std::invalid_argument("TimerWheel tick must be positive");
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Round up so a timer never fires before its delay
+    uint64_t ticks = static_cast<uint64_t>((delay.count() + tick.count() - 1) / tick.count());
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    size_t slot = (cursor + ticks) % slots.size();
+    uint64_t rounds = (ticks - 1) / slots.size();
+
+    TimerId id = nextId++;
+    slots[slot].push_back(Timer{ id, rounds, std::move(callback) });
+    slotOf[id] = slot;
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = slotOf.find(id);
+    if (it == slotOf.end()) {
+        return false;
+    }
+
+    std::vector<Timer>& slot = slots[it->second];
+    for (size_t i = 0; i < slot.size(); i++) {
+        if (slot[i].id == id) {
+            slot[i] = std::move(slot.back());
+            slot.pop_back();
+            break;
+        }
+    }
+
+    slotOf.erase(it);
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now) {
+    std::vector<Callback> due;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        while (nextTick <= now) {
+            cursor = (cursor + 1) % slots.size();
+            nextTick += tick;
+
+            std::vector<Timer>& slot = slots[cursor];
+            size_t kept = 0;
+            for (size_t i = 0; i < slot.size(); i++) {
+                if (slot[i].rounds == 0) {
+                    slotOf.erase(slot[i].id);
+                    due.push_back(std::move(slot[i].callback));
+                }
+                else {
+                    slot[i].rounds--;
+                    if (kept != i) {
+                        slot[kept] = std::move(slot[i]);
+                    }
+                    kept++;
+                }
+            }
+            slot.resize(kept);
+        }
+    }
+
+    // Callbacks may schedule or cancel timers
+    for (auto& callback : due) {
+        callback();
+    }
+}
+
+size_t TimerWheel::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slotOf.size();
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+// include/TimerWheel.h
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Hashed timing wheel driven by an event loop.
+//
+// schedule()/cancel() are O(1) and may be called from any thread;
+// callbacks run on the thread calling advance(), outside the lock.
+// Resolution is one tick; timers never fire early.
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;
+    typedef std::function<void()> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(50),
+        size_t slotCount = 256);
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    bool cancel(TimerId id);
+
+    // Fire everything due up to now
+    void advance(Clock::time_point now = Clock::now());
+
+    size_t pending() const;
+
+private:
+    struct Timer {
+        TimerId id;
+        uint64_t rounds;    // Full wheel turns left before firing
+        Callback callback;
+    };
+
+    std::chrono::milliseconds tick;
+    std::vector<std::vector<Timer>> slots;
+
+    mutable std::mutex mutex;
+    std::unordered_map<TimerId, size_t> slotOf;
+    TimerId nextId;
+    size_t cursor;
+    Clock::time_point nextTick;
+};
+
+#endif // TIMER_WHEEL_H
\ No newline at end of file
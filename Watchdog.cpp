@@ -0,0 +1,271 @@
+// src/Watchdog.cpp
+#include "Watchdog.h"
+#include "Logger.h"
+#include "ThreadPolicy.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+
+namespace {
+    const int kCaptureSignal = SIGUSR2;
+    const int kMaxFrames = 64;
+    const int kCaptureWaitMs = 500;
+    const int kMinIntervalMs = 100;
+
+    // Shared with the signal handler; only async-signal-safe calls there
+    std::atomic<int> g_reportFd(-1);
+    std::atomic<bool> g_captureDone(false);
+
+    void onCaptureSignal(int) {
+        void* frames[kMaxFrames];
+        int depth = backtrace(frames, kMaxFrames);
+        int fd = g_reportFd.load();
+        if (fd >= 0) {
+            backtrace_symbols_fd(frames, depth, fd);
+        }
+        g_captureDone.store(true);
+    }
+
+    int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// Constructor
+Watchdog& Watchdog::instance() {
+    static Watchdog watchdog;
+    return watchdog;
+}
+
+Watchdog::Watchdog()
+    : timeoutMs(0),
+    running(false) {
+    for (size_t i = 0; i < kMaxThreads; i++) {
+        slots[i].beats.store(0, std::memory_order_relaxed);
+        slots[i].inUse.store(false, std::memory_order_relaxed);
+        slots[i].tid = 0;
+        slots[i].name[0] = '\0';
+        slots[i].lastBeats = 0;
+        slots[i].lastChangeMs = 0;
+    }
+}
+
+void Watchdog::setRestartCommand(int argc, char* argv[]) {
+    restartArgs.assign(argv, argv + argc);
+}
+
+// Monitor Management
+void Watchdog::start(int timeout, const std::string& path) {
+    if (timeout <= 0 || running.exchange(true)) {
+        return;
+    }
+
+    timeoutMs = timeout;
+    reportPath = path;
+
+    // backtrace() loads libgcc on first use, which is not signal-safe
+    void* frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onCaptureSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(kCaptureSignal, &action, nullptr);
+
+    {
+        // Leases taken before start() begin their grace period now
+        std::lock_guard<std::mutex> lock(monitorMutex);
+        int64_t now = nowMs();
+        for (size_t i = 0; i < kMaxThreads; i++) {
+            slots[i].lastBeats = slots[i].beats.load(std::memory_order_relaxed);
+            slots[i].lastChangeMs = now;
+        }
+    }
+
+    monitorThread = std::thread(&Watchdog::runMonitor, this);
+}
+
+void Watchdog::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    monitorCondition.notify_one();
+    if (monitorThread.joinable()) {
+        monitorThread.join();
+    }
+}
+
+// Registration
+Watchdog::Slot* Watchdog::acquireSlot(const char* name) {
+    std::lock_guard<std::mutex> lock(monitorMutex);
+
+    for (size_t i = 0; i < kMaxThreads; i++) {
+        Slot& slot = slots[i];
+        if (slot.inUse.load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        slot.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        strncpy(slot.name, name, sizeof(slot.name) - 1);
+        slot.name[sizeof(slot.name) - 1] = '\0';
+        slot.beats.store(0, std::memory_order_relaxed);
+        slot.lastBeats = 0;
+        slot.lastChangeMs = nowMs();
+        slot.inUse.store(true, std::memory_order_relaxed);
+        return &slot;
+    }
+
+    LOG_WARN("Watchdog: no free slot for thread %s", name);
+    return nullptr;
+}
+
+void Watchdog::releaseSlot(Slot* slot) {
+    std::lock_guard<std::mutex> lock(monitorMutex);
+    slot->inUse.store(false, std::memory_order_relaxed);
+}
+
+// Monitoring
+void Watchdog::runMonitor() {
+    ThreadPolicy("rtc-watchdog").apply();
+
+    const int64_t interval = std::max(timeoutMs / 4, kMinIntervalMs);
+    int64_t lastWakeMs = nowMs();
+
+    std::unique_lock<std::mutex> lock(monitorMutex);
+    while (running) {
+        monitorCondition.wait_for(lock, std::chrono::milliseconds(interval));
+        if (!running) {
+            break;
+        }
+
+        // If we ourselves were starved for a long stretch, every thread
+        // looks stuck; start their grace periods over instead
+        int64_t now = nowMs();
+        bool monitorStarved = now - lastWakeMs > interval + timeoutMs / 2;
+        lastWakeMs = now;
+
+        for (size_t i = 0; i < kMaxThreads; i++) {
+            Slot& slot = slots[i];
+            if (!slot.inUse.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            uint64_t beats = slot.beats.load(std::memory_order_relaxed);
+            if (beats != slot.lastBeats || monitorStarved) {
+                slot.lastBeats = beats;
+                slot.lastChangeMs = now;
+            }
+            else if (now - slot.lastChangeMs >= timeoutMs) {
+                handleHang(slot, now - slot.lastChangeMs);
+            }
+        }
+    }
+}
+
+void Watchdog::handleHang(Slot& slot, int64_t stalledMs) {
+    LOG_ERROR("Watchdog: thread %s (tid %d) stalled for %lld ms, restarting",
+        slot.name, slot.tid, stalledMs);
+
+    int fd = open(reportPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        dprintf(fd, "thread=%s tid=%d stalled_ms=%lld time=%lld\n",
+            slot.name, static_cast<int>(slot.tid),
+            static_cast<long long>(stalledMs), static_cast<long long>(time(nullptr)));
+        for (size_t i = 0; i < kMaxThreads; i++) {
+            if (slots[i].inUse.load(std::memory_order_relaxed)) {
+                dprintf(fd, "watched=%s tid=%d beats=%llu\n", slots[i].name,
+                    static_cast<int>(slots[i].tid),
+                    static_cast<unsigned long long>(slots[i].beats.load(std::memory_order_relaxed)));
+            }
+        }
+        dprintf(fd, "backtrace:\n");
+    }
+
+    // The stuck thread writes its own stack from the signal handler
+    g_captureDone.store(false);
+    g_reportFd.store(fd);
+    if (syscall(SYS_tgkill, getpid(), slot.tid, kCaptureSignal) == 0) {
+        for (int waited = 0; waited < kCaptureWaitMs && !g_captureDone.load(); waited += 10) {
+            usleep(10 * 1000);
+        }
+    }
+    g_reportFd.store(-1);
+
+    if (fd >= 0) {
+        if (!g_captureDone.load()) {
+            dprintf(fd, "(no response to capture signal)\n");
+        }
+        fsync(fd);
+        close(fd);
+    }
+
+    restart();
+}
+
+void Watchdog::restart() {
+    // An armed profiling timer survives exec and SIGPROF would kill the new image
+    struct itimerval disarm;
+    memset(&disarm, 0, sizeof(disarm));
+    setitimer(ITIMER_PROF, &disarm, nullptr);
+
+    // Sockets and files must not leak into the new image
+    long maxFd = sysconf(_SC_OPEN_MAX);
+    if (maxFd < 0 || maxFd > 4096) {
+        maxFd = 4096;
+    }
+    for (int fd = 3; fd < maxFd; fd++) {
+        close(fd);
+    }
+
+    if (!restartArgs.empty()) {
+        std::vector<char*> argv;
+        for (auto& arg : restartArgs) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+        execv("/proc/self/exe", argv.data());
+    }
+
+    // Could not re-exec; leave it to the supervisor
+    _exit(kHangExitCode);
+}
+
+bool Watchdog::takeReport(const std::string& path, std::string& report) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    report = contents.str();
+
+    file.close();
+    unlink(path.c_str());
+    return !report.empty();
+}
+
+// WatchdogLease
+WatchdogLease::WatchdogLease(const char* name)
+    : slot(Watchdog::instance().acquireSlot(name)) {
+}
+
+WatchdogLease::~WatchdogLease() {
+    if (slot) {
+        Watchdog::instance().releaseSlot(slot);
+    }
+}
\ No newline at end of file
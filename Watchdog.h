@@ -0,0 +1,96 @@
+// include/Watchdog.h
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include <sys/types.h>
+
+// Heartbeat-counter watchdog for long-lived threads.
+//
+// Each watched thread holds a WatchdogLease and kicks it once per loop
+// iteration (one relaxed increment). A monitor thread samples the
+// counters; when one has not moved for the timeout, the stuck thread is
+// sent SIGUSR2 and captures its own backtrace into a hang report file.
+// The process then re-executes itself. After the restart the report is
+// picked up with takeReport() and sent upstream as DIAGNOSTICS.
+class Watchdog {
+public:
+    static Watchdog& instance();
+
+    // Exit status when re-exec fails, so a supervisor can restart us
+    static const int kHangExitCode = 70;
+
+    // Arguments for the re-exec; call from main() before start()
+    void setRestartCommand(int argc, char* argv[]);
+
+    // Begin monitoring. Leases taken before start() are covered too.
+    void start(int timeoutMs, const std::string& reportPath);
+    void stop();
+
+    // Read and remove the report left by a previous hang, if any
+    static bool takeReport(const std::string& reportPath, std::string& report);
+
+private:
+    Watchdog();
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    static const size_t kMaxThreads = 16;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> beats;
+        std::atomic<bool> inUse;
+        pid_t tid;
+        char name[16];
+
+        // Monitor-only bookkeeping
+        uint64_t lastBeats;
+        int64_t lastChangeMs;
+    };
+
+    Slot slots[kMaxThreads];
+    std::vector<std::string> restartArgs;
+
+    int timeoutMs;
+    std::string reportPath;
+    std::atomic<bool> running;
+    std::thread monitorThread;
+    std::mutex monitorMutex;
+    std::condition_variable monitorCondition;
+
+    Slot* acquireSlot(const char* name);
+    void releaseSlot(Slot* slot);
+
+    void runMonitor();
+    void handleHang(Slot& slot, int64_t stalledMs);
+    void restart();
+
+    friend class WatchdogLease;
+};
+
+// Registers the calling thread with the watchdog for its lifetime
+class WatchdogLease {
+public:
+    explicit WatchdogLease(const char* name);
+    ~WatchdogLease();
+
+    void kick() {
+        if (slot) {
+            slot->beats.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    WatchdogLease(const WatchdogLease&) = delete;
+    WatchdogLease& operator=(const WatchdogLease&) = delete;
+
+private:
+    Watchdog::Slot* slot;
+};
+
+#endif // WATCHDOG_H
\ No newline at end of file
@@ -0,0 +1,267 @@
+// src/jsonbench_main.cpp
+//
+// Benchmark of the signaling JSON path: cJSON's printer and parser
+// against JsonCodec on the same documents.
+//
+//   jsonbench [--iterations N] [document.json ...]
+//
+// Without documents it uses a HEARTBEAT message shaped like the device's
+// (uptime, temperature, memory, capacity and link telemetry) and an OFFER
+// carrying a browser-sized SDP. Each document is printed formatted (the
+// wire format), printed compact and parsed, in CPU time of the
+// benchmarking thread. JsonCodec parses in place as the receive path
+// does, from a copy made per run and included in its time. Both codecs
+// must parse each other's output back to the same tree, or the run fails.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "JsonCodec.h"
+#include "SignalingProtocol.h"
+
+namespace {
+    const size_t kDefaultIterations = 200000;
+
+    uint64_t threadCpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+    }
+
+    bool readFile(const char* path, std::string& text) {
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            return false;
+        }
+        char chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            text.append(chunk, n);
+        }
+        fclose(file);
+        return true;
+    }
+
+    // Values as a running camera reports them: mostly non-integral
+    std::string heartbeatDocument() {
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddNumberToObject(payload, "uptime", 183742.61);
+        cJSON_AddNumberToObject(payload, "temperature", 57.312);
+
+        cJSON* memory = cJSON_AddObjectToObject(payload, "memory");
+        const char* tags[] = { "json", "websocket", "queues", "packets" };
+        for (size_t i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+            cJSON* tag = cJSON_AddObjectToObject(memory, tags[i]);
+            cJSON_AddNumberToObject(tag, "used", 18342.0 * (i + 1));
+            cJSON_AddNumberToObject(tag, "peak", 40211.0 * (i + 1));
+            cJSON_AddNumberToObject(tag, "budget", 262144.0 * (i + 1));
+            cJSON_AddNumberToObject(tag, "rejected", 0);
+        }
+
+        cJSON* capacity = cJSON_AddObjectToObject(payload, "capacity");
+        cJSON_AddNumberToObject(capacity, "viewers", 3);
+        cJSON_AddNumberToObject(capacity, "cpu", 0.4172913);
+        cJSON_AddNumberToObject(capacity, "uplink_kbps", 5812.37);
+        cJSON_AddNumberToObject(capacity, "bitrate_kbps", 1987.6406);
+        cJSON_AddNumberToObject(capacity, "headroom", 0.18345);
+        cJSON_AddStringToObject(capacity, "quality", "high");
+
+        cJSON* link = cJSON_AddObjectToObject(payload, "link");
+        cJSON_AddNumberToObject(link, "rtt_ms", 48.125);
+        cJSON_AddNumberToObject(link, "rtt_var_ms", 6.875);
+        cJSON_AddNumberToObject(link, "retransmits", 2);
+        cJSON_AddNumberToObject(link, "unacked", 0);
+        cJSON_AddNumberToObject(link, "send_queue_bytes", 1432);
+        cJSON_AddNumberToObject(link, "choked_ms", 117);
+        cJSON_AddBoolToObject(payload, "motion", false);
+
+        SignalingMessage heartbeat(SignalingMessageType::HEARTBEAT, "vp18abc3");
+        heartbeat.setPayload(payload);
+        heartbeat.addMetadata("ack", "41");
+        cJSON_Delete(payload);
+        return heartbeat.serialize();
+    }
+
+    // Audio plus a video section offering the usual codec set, as sent by
+    // a desktop browser
+    std::string offerDocument() {
+        std::string sdp =
+            "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n"
+            "a=group:BUNDLE 0 1\r\na=extmap-allow-mixed\r\na=msid-semantic: WMS\r\n"
+            "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126\r\nc=IN IP4 0.0.0.0\r\n"
+            "a=rtcp:9 IN IP4 0.0.0.0\r\na=ice-ufrag:Pc7m\r\na=ice-pwd:Ff4zH3nLq2vX8bKd0rTgYw1s\r\n"
+            "a=ice-options:trickle\r\na=fingerprint:sha-256 "
+            "3C:4E:12:9A:7F:0B:D2:58:A1:66:E4:19:8D:CB:30:F7:52:9E:04:BB:71:2D:C8:5A:16:EF:93:40:6B:A7:D1:3F\r\n"
+            "a=setup:actpass\r\na=mid:0\r\na=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+            "a=recvonly\r\na=rtcp-mux\r\na=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\n"
+            "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+            "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 102 103 104 105 106 107 108 109 127 125\r\n"
+            "c=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\na=ice-ufrag:Pc7m\r\n"
+            "a=ice-pwd:Ff4zH3nLq2vX8bKd0rTgYw1s\r\na=ice-options:trickle\r\na=setup:actpass\r\na=mid:1\r\n"
+            "a=extmap:2 urn:ietf:params:rtp-hdrext:toffset\r\n"
+            "a=extmap:3 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+            "a=extmap:4 urn:3gpp:video-orientation\r\na=recvonly\r\na=rtcp-mux\r\na=rtcp-rsize\r\n";
+        const char* codecs[] = { "VP8", "VP9", "H264", "AV1" };
+        for (int pt = 96; pt < 110; pt += 2) {
+            std::string payloadType = std::to_string(pt);
+            std::string rtxType = std::to_string(pt + 1);
+            sdp += "a=rtpmap:" + payloadType + " " + codecs[(pt - 96) / 2 % 4] + "/90000\r\n";
+            sdp += "a=rtcp-fb:" + payloadType + " goog-remb\r\na=rtcp-fb:" + payloadType + " transport-cc\r\n";
+            sdp += "a=rtcp-fb:" + payloadType + " ccm fir\r\na=rtcp-fb:" + payloadType + " nack\r\n";
+            sdp += "a=rtcp-fb:" + payloadType + " nack pli\r\n";
+            sdp += "a=fmtp:" + payloadType + " level-asymmetry-allowed=1;packetization-mode=1;"
+                "profile-level-id=42e01f\r\n";
+            sdp += "a=rtpmap:" + rtxType + " rtx/90000\r\na=fmtp:" + rtxType + " apt=" + payloadType + "\r\n";
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "type", "offer");
+        cJSON_AddStringToObject(payload, "sdp", sdp.c_str());
+        cJSON_AddStringToObject(payload, "viewer_id", "viewer-7f3a91");
+
+        SignalingMessage offer(SignalingMessageType::OFFER, "vp18abc4");
+        offer.setPayload(payload);
+        cJSON_Delete(payload);
+        return offer.serialize();
+    }
+
+    template <typename Work>
+    double nanosPerRun(size_t iterations, Work work) {
+        uint64_t start = threadCpuNanos();
+        for (size_t i = 0; i < iterations; i++) {
+            work();
+        }
+        return double(threadCpuNanos() - start) / iterations;
+    }
+
+    struct Row {
+        const char* name;
+        size_t bytes;
+        double cjsonNs;
+        double codecNs;
+    };
+
+    // Each codec's output must read back as the same tree
+    bool sameTree(cJSON* reference, cJSON* other) {
+        bool same = reference && other && cJSON_Compare(reference, other, 1);
+        cJSON_Delete(other);
+        return same;
+    }
+
+    bool bench(const std::string& name, const std::string& text, size_t iterations) {
+        cJSON* tree = jsonParse(text);
+        if (!tree) {
+            std::cerr << name << ": not valid JSON\n";
+            return false;
+        }
+
+        char* printed = cJSON_Print(tree);
+        std::string cjsonText = printed ? printed : "";
+        cJSON_free(printed);
+        std::string codecText = jsonPrint(tree);
+        if (!sameTree(tree, jsonParse(cjsonText)) || !sameTree(tree, cJSON_Parse(codecText.c_str()))) {
+            std::cerr << name << ": codecs disagree\n";
+            cJSON_Delete(tree);
+            return false;
+        }
+
+        volatile size_t consumed = 0;       // Keeps the work observable
+        std::vector<Row> rows;
+        std::string receiveBuffer;
+        receiveBuffer.reserve(codecText.size());
+
+        rows.push_back({ "print", codecText.size(),
+            nanosPerRun(iterations, [&]() {
+                char* out = cJSON_Print(tree);
+                consumed += strlen(out);
+                cJSON_free(out);
+            }),
+            nanosPerRun(iterations, [&]() { consumed += jsonPrint(tree).size(); }) });
+
+        rows.push_back({ "compact", jsonPrint(tree, false).size(),
+            nanosPerRun(iterations, [&]() {
+                char* out = cJSON_PrintUnformatted(tree);
+                consumed += strlen(out);
+                cJSON_free(out);
+            }),
+            nanosPerRun(iterations, [&]() { consumed += jsonPrint(tree, false).size(); }) });
+
+        rows.push_back({ "parse", codecText.size(),
+            nanosPerRun(iterations, [&]() {
+                cJSON* parsed = cJSON_Parse(codecText.c_str());
+                consumed += parsed != nullptr;
+                cJSON_Delete(parsed);
+            }),
+            nanosPerRun(iterations, [&]() {
+                receiveBuffer.assign(codecText);
+                cJSON* parsed = jsonParseInPlace(&receiveBuffer[0], receiveBuffer.size());
+                consumed += parsed != nullptr;
+                cJSON_Delete(parsed);
+            }) });
+
+        cJSON_Delete(tree);
+
+        std::cout << name << ": " << codecText.size() << " bytes, " << iterations << " iterations"
+            << (cjsonText == codecText ? "" : " (number text differs from cJSON)") << "\n";
+        std::cout << "            cJSON    JsonCodec   speedup   JsonCodec\n";
+        for (const Row& row : rows) {
+            std::cout << "  " << std::left << std::setw(8) << row.name << std::right
+                << std::fixed << std::setprecision(0)
+                << std::setw(8) << row.cjsonNs << " ns" << std::setw(9) << row.codecNs << " ns"
+                << std::setprecision(2) << std::setw(9) << row.cjsonNs / row.codecNs << "x"
+                << std::setprecision(0) << std::setw(7) << row.bytes * 1e3 / row.codecNs
+                << " MB/s\n";
+        }
+        std::cout << "\n";
+
+        (void)consumed;
+        return true;
+    }
+}
+
+static void usage() {
+    std::cerr << "usage: jsonbench [--iterations N] [document.json ...]\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = kDefaultIterations;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        }
+        else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (iterations == 0) {
+        usage();
+        return 2;
+    }
+
+    bool ok = true;
+    if (paths.empty()) {
+        ok = bench("heartbeat", heartbeatDocument(), iterations);
+        ok = bench("offer", offerDocument(), iterations / 10 + 1) && ok;
+    }
+    for (const char* path : paths) {
+        std::string text;
+        if (!readFile(path, text)) {
+            std::cerr << "Could not read " << path << "\n";
+            ok = false;
+            continue;
+        }
+        ok = bench(path, text, iterations) && ok;
+    }
+    return ok ? 0 : 1;
+}
\ No newline at end of file
@@ -4,13 +4,44 @@
 #include <thread>
 #include <chrono>
 #include <memory>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <algorithm>
 
 #include "SignalingClient.h"
 #include "DeviceConfig.h"
+#include "MessageId.h"
+#include "MessageTemplate.h"
+#include "SamplingProfiler.h"
+#include "StreamStats.h"
+#include "Logger.h"
+#include "MemoryAccounting.h"
+#include "Watchdog.h"
+#include "MotionDetector.h"
+#include "SnapshotService.h"
+#include "RequestRouter.h"
+#include "CapacityModel.h"
+#include "RtpRelay.h"
 
 // Global signal handling
 namespace {
     std::atomic<bool> g_running(true);
+
+    // REQUEST actions
+    constexpr uint32_t kActionStream = requestActionHash("stream");
+    constexpr uint32_t kActionSnapshot = requestActionHash("snapshot");
+    constexpr uint32_t kActionPtz = requestActionHash("ptz");
+    constexpr uint32_t kActionConfig = requestActionHash("config");
+    constexpr uint32_t kActionDiag = requestActionHash("diag");
+
+    // Slots of the recurring message templates
+    enum HeartbeatSlot { kHeartbeatUptime, kHeartbeatTemperature, kHeartbeatMemory,
+        kHeartbeatCapacity, kHeartbeatLink, kHeartbeatMotion };
+    enum MotionSlot { kMotionScore, kMotionX, kMotionY, kMotionWidth, kMotionHeight };
+
+    // How long the relay waits for a camera to answer its OFFER
+    const std::chrono::seconds kCameraAnswerTimeout(10);
 }
 
 void signalHandler(int signum) {
@@ -22,12 +53,108 @@ void signalHandler(int signum) {
 class DeviceManager {
 private:
     DeviceConfig config;
+    MessageIdGenerator messageIds;
     std::unique_ptr<SignalingClient> signalingClient;
 
+    // Live stream statistics and the last STREAM_INFO we published;
+    // written by the main loop, read by queries on the signaling thread
+    StreamStats streamStats;
+    std::mutex publishedMutex;
+    StreamInfo publishedStreamInfo;
+
+    // Whether another viewer fits, and at which quality
+    CapacityModel capacityModel;
+
+    // Motion events are reported as STATUS
+    MotionDetector motionDetector;
+
+    // Cached JPEG stills for dashboard polls
+    SnapshotService snapshotService;
+
+    // REQUEST dispatch with per-action admission limits; an admitted
+    // stream keeps its ticket until the viewer's session ends
+    RequestRouter requestRouter;
+    std::map<std::string, RequestRouter::Ticket> streamTickets;
+
+    // Background work for DIAGNOSTICS requests
+    std::thread diagnosticsThread;
+    std::atomic<bool> diagnosticsBusy;
+
+    // Whether we were over a memory budget at the last tick
+    bool memoryPressure;
+
+    // Signaling servers in failover order and how long the current one
+    // has been degraded
+    std::vector<std::string> signalingServers;
+    size_t signalingServer;
+    int degradedSecs;
+    uint64_t lastChokedMs;
+
+    // Recurring messages, serialized once and patched per send. The
+    // motion ones belong to the motion thread, the rest to the main one.
+    MessageTemplate registrationTemplate;
+    MessageTemplate heartbeatTemplate;
+    MessageTemplate motionStartTemplate;
+    MessageTemplate motionEndTemplate;
+    PreparedMessage heartbeatFrame;
+    PreparedMessage motionFrame;
+
 public:
     DeviceManager(const std::string& configPath, const std::string& signalingUrl)
         : config(DeviceConfig::loadFromFile(configPath)),
-        signalingClient(new SignalingClient(signalingUrl)) {
+        messageIds(config.deviceId),
+        signalingClient(new SignalingClient(signalingUrl)),
+        streamStats(config.stream),
+        capacityModel(config.capacity, config.stream),
+        motionDetector(config.motion),
+        snapshotService(config.snapshot),
+        requestRouter("stream"),
+        diagnosticsBusy(false),
+        memoryPressure(false),
+        signalingServer(0),
+        degradedSecs(0),
+        lastChokedMs(0),
+        registrationTemplate(SignalingMessageType::REGISTER),
+        heartbeatTemplate(SignalingMessageType::HEARTBEAT),
+        motionStartTemplate(SignalingMessageType::STATUS),
+        motionEndTemplate(SignalingMessageType::STATUS) {
+
+        // Logging destination and verbosity
+        LogLevel level;
+        if (stringToLogLevel(config.logLevel, level)) {
+            Logger::instance().setLevel(level);
+        }
+        if (!config.logFile.empty() && !Logger::instance().setOutputFile(config.logFile)) {
+            LOG_WARN("Could not open log file %s, using stderr", config.logFile);
+        }
+
+        // Scheduling for this thread and the ones we start
+        config.mainThread.apply();
+        Logger::instance().setThreadPolicy(config.logThread);
+        signalingClient->setThreadPolicy(config.signalingThread);
+        if (config.lockMemory) {
+            lockProcessMemory();
+        }
+
+        // Memory budgets; optional work is shed when one is exceeded
+        MemoryAccounting::setBudget(MemoryTag::JSON, static_cast<size_t>(config.memory.jsonKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::WEBSOCKET, static_cast<size_t>(config.memory.websocketKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::QUEUES, static_cast<size_t>(config.memory.queuesKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::PACKETS, static_cast<size_t>(config.memory.packetsKb) * 1024);
+
+        // REGISTER, RESPONSE and ANSWER survive connection drops
+        signalingClient->setReliableDelivery(true);
+        if (!config.capture.path.empty()) {
+            signalingClient->setCapture(config.capture.path,
+                static_cast<size_t>(config.capture.fileKb) * 1024, config.capture.files);
+        }
+
+        signalingServers.push_back(signalingUrl);
+        signalingServers.insert(signalingServers.end(),
+            config.signaling.fallbackUrls.begin(), config.signaling.fallbackUrls.end());
+
+        registerRequestRoutes();
+        compileTemplates();
 
         // Setup message callback
         signalingClient->setMessageCallback(
@@ -38,7 +165,7 @@ public:
     bool initialize() {
         // Connect to signaling server
         if (!signalingClient->connect()) {
-            std::cerr << "Failed to connect to signaling server\n";
+            LOG_ERROR("Failed to connect to signaling server");
             return false;
         }
 
@@ -48,96 +175,693 @@ public:
         // Send initial registration
         sendRegistration();
 
+        // Report a hang from before our last restart, then start watching
+        std::string hangReport;
+        if (Watchdog::takeReport(config.hangReportPath, hangReport)) {
+            sendHangReport(hangReport);
+        }
+        Watchdog::instance().start(config.watchdogTimeoutMs, config.hangReportPath);
+
+        snapshotService.start(config.snapshotThread);
+
+        if (config.motion.enabled) {
+            motionDetector.start(config.motionThread,
+                std::bind(&DeviceManager::sendMotionStatus, this, std::placeholders::_1));
+        }
+
         return true;
     }
 
     void run() {
+        const int heartbeatIntervalSecs = 30;
+        int ticks = 0;
+        WatchdogLease watchdog("rtc-main");
+
         while (g_running) {
+            watchdog.kick();
+
+            // Report budget transitions once rather than on every shed item
+            bool pressure = MemoryAccounting::underPressure();
+            if (pressure != memoryPressure) {
+                memoryPressure = pressure;
+                if (pressure) {
+                    LOG_WARN("Memory budget exceeded, shedding optional work");
+                }
+                else {
+                    LOG_INFO("Memory usage back within budget");
+                }
+            }
+
             // Periodic tasks
-            sendHeartbeat();
+            if (ticks % heartbeatIntervalSecs == 0) {
+                sendHeartbeat();
+            }
+            checkSignalingLink();
+
+            // Publish STREAM_INFO whenever the stream changes noticeably
+            StreamInfo info = streamStats.sample();
+            capacityModel.sample(info);
+            if (ticks == 0 || StreamStats::significantChange(publishedStreamInfo, info)) {
+                sendStreamInfo(info, nullptr);
+            }
 
-            // Small sleep to prevent tight looping
-            std::this_thread::sleep_for(std::chrono::seconds(30));
+            ticks++;
+
+            // One-second tick keeps change detection responsive
+            std::this_thread::sleep_for(std::chrono::seconds(1));
         }
 
-        // Cleanup
+        // Cleanup; a slow shutdown is not a hang
+        Watchdog::instance().stop();
+        Logger::instance().clearStream();
+        motionDetector.stop();
+        snapshotService.stop();
+        if (diagnosticsThread.joinable()) {
+            diagnosticsThread.join();
+        }
         signalingClient->disconnect();
     }
 
 private:
-    void sendRegistration() {
-        SignalingMessage registrationMsg(SignalingMessageType::REGISTER, config.deviceId);
+    // Same payloads the cJSON builders used to produce, with slots where
+    // the values change between sends
+    void compileTemplates() {
+        std::map<std::string, std::string> metadata;
+        metadata["version"] = "1.0.0";
+        metadata["stream_count"] = "1";
+        metadata["id_format"] = "base32";
 
-        // Prepare registration payload
         cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "device_id", config.deviceId.c_str());
         cJSON_AddStringToObject(payload, "device_type", "camera");
         cJSON_AddStringToObject(payload, "mac_address", config.macAddress.c_str());
         cJSON_AddStringToObject(payload, "csn", config.cloudSerialNumber.c_str());
+        registrationTemplate.compile(payload, metadata);
+        cJSON_Delete(payload);
 
-        registrationMsg.setPayload(payload);
+        payload = cJSON_CreateObject();
+        cJSON_AddItemToObject(payload, "uptime", MessageTemplate::slot(kHeartbeatUptime));
+        cJSON_AddItemToObject(payload, "temperature", MessageTemplate::slot(kHeartbeatTemperature));
+        cJSON_AddItemToObject(payload, "memory", MessageTemplate::slot(kHeartbeatMemory));
+        cJSON_AddItemToObject(payload, "capacity", MessageTemplate::slot(kHeartbeatCapacity));
+        cJSON_AddItemToObject(payload, "link", MessageTemplate::slot(kHeartbeatLink));
+        if (config.motion.enabled) {
+            cJSON_AddItemToObject(payload, "motion", MessageTemplate::slot(kHeartbeatMotion));
+        }
+        heartbeatTemplate.compile(payload);
+        cJSON_Delete(payload);
 
-        // Add metadata
-        registrationMsg.addMetadata("version", "1.0.0");
-        registrationMsg.addMetadata("stream_count", "1");
+        payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "event", "motion");
+        cJSON_AddStringToObject(payload, "state", "start");
+        cJSON_AddItemToObject(payload, "score", MessageTemplate::slot(kMotionScore));
+        cJSON* region = cJSON_AddObjectToObject(payload, "region");
+        cJSON_AddItemToObject(region, "x", MessageTemplate::slot(kMotionX));
+        cJSON_AddItemToObject(region, "y", MessageTemplate::slot(kMotionY));
+        cJSON_AddItemToObject(region, "width", MessageTemplate::slot(kMotionWidth));
+        cJSON_AddItemToObject(region, "height", MessageTemplate::slot(kMotionHeight));
+        motionStartTemplate.compile(payload);
+        cJSON_Delete(payload);
+
+        payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "event", "motion");
+        cJSON_AddStringToObject(payload, "state", "end");
+        cJSON_AddItemToObject(payload, "score", MessageTemplate::slot(kMotionScore));
+        motionEndTemplate.compile(payload);
+        cJSON_Delete(payload);
+    }
+
+    void sendRegistration() {
+        // Nothing but the id changes between registrations
+        PreparedMessage registration;
+        registrationTemplate.render(messageIds.next(), registration);
+        signalingClient->sendMessage(registration);
+    }
 
-        // Send registration
-        signalingClient->sendMessage(registrationMsg);
+    // Called once a second. A server that stays slow or backed up (or
+    // unreachable) for degraded_secs is left for the next one in the list;
+    // with a single server, a lost connection is simply re-established.
+    void checkSignalingLink() {
+        SignalingClient::LinkStats link = signalingClient->getLinkStats();
+        uint64_t chokedMs = link.chokedMs - std::min(lastChokedMs, link.chokedMs);
+        lastChokedMs = link.chokedMs;
 
-        // Free the JSON object
+        bool degraded = !signalingClient->isConnected() ||
+            (link.valid && (link.rttUs / 1000 > static_cast<uint32_t>(config.signaling.maxRttMs) ||
+                chokedMs * 100 > static_cast<uint64_t>(config.signaling.maxChokedPct) * 1000));
+        degradedSecs = degraded ? degradedSecs + 1 : 0;
+        if (degradedSecs < config.signaling.degradedSecs ||
+            (signalingServers.size() < 2 && signalingClient->isConnected())) {
+            return;
+        }
+        degradedSecs = 0;
+
+        signalingServer = (signalingServer + 1) % signalingServers.size();
+        const std::string& url = signalingServers[signalingServer];
+        LOG_WARN("Signaling link degraded (rtt %u ms, choked %u ms/s), moving to %s",
+            link.rttUs / 1000, chokedMs, url);
+
+        signalingClient->disconnect();
+        signalingClient->setServerUrl(url);
+        if (!signalingClient->connect()) {
+            LOG_ERROR("Failed to connect to signaling server %s", url);
+            return;
+        }
+        signalingClient->startEventLoop();
+
+        try {
+            sendRegistration();
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to register with %s: %s", url, e.what());
+        }
+    }
+
+    void sendHangReport(const std::string& report) {
+        LOG_WARN("Recovered from a hang:");
+        Logger::instance().logLines(LogLevel::WARN, report);
+
+        SignalingMessage hang(SignalingMessageType::DIAGNOSTICS, messageIds.next().str());
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "kind", "hang");
+        cJSON_AddStringToObject(payload, "data", report.c_str());
+        hang.setPayload(payload);
         cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(hang);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send hang report: %s", e.what());
+        }
     }
 
     void sendHeartbeat() {
-        SignalingMessage heartbeat(SignalingMessageType::HEARTBEAT, config.deviceId);
+        // System status; the component snapshots are still built as JSON
+        heartbeatTemplate.setDouble(kHeartbeatUptime, getSystemUptime());
+        heartbeatTemplate.setDouble(kHeartbeatTemperature, getSystemTemperature());
+        heartbeatTemplate.setJson(kHeartbeatMemory, MemoryAccounting::toJson());
+        heartbeatTemplate.setJson(kHeartbeatCapacity, capacityModel.toJson());
+        heartbeatTemplate.setJson(kHeartbeatLink, signalingClient->getLinkStats().toJson());
+        if (config.motion.enabled) {
+            heartbeatTemplate.setBool(kHeartbeatMotion, motionDetector.isActive());
+        }
+        heartbeatTemplate.render(messageIds.next(), heartbeatFrame);
 
-        // Optional payload with system status
-        cJSON* payload = cJSON_CreateObject();
-        cJSON_AddNumberToObject(payload, "uptime", getSystemUptime());
-        cJSON_AddNumberToObject(payload, "temperature", getSystemTemperature());
+        // A missed heartbeat must not take the main loop down with it
+        try {
+            signalingClient->sendMessage(heartbeatFrame);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send heartbeat: %s", e.what());
+        }
+    }
 
-        heartbeat.setPayload(payload);
+    // Runs on the motion analysis thread
+    void sendMotionStatus(const MotionEvent& event) {
+        LOG_INFO("Motion %s (score %.3f)", event.active ? "started" : "ended", event.score);
 
-        signalingClient->sendMessage(heartbeat);
+        // Same payload as MotionEvent::toJson()
+        if (event.active) {
+            motionStartTemplate.setDouble(kMotionScore, event.score);
+            motionStartTemplate.setInt(kMotionX, event.x);
+            motionStartTemplate.setInt(kMotionY, event.y);
+            motionStartTemplate.setInt(kMotionWidth, event.width);
+            motionStartTemplate.setInt(kMotionHeight, event.height);
+            motionStartTemplate.render(messageIds.next(), motionFrame);
+        }
+        else {
+            motionEndTemplate.setDouble(kMotionScore, event.score);
+            motionEndTemplate.render(messageIds.next(), motionFrame);
+        }
 
-        // Free the JSON object
-        cJSON_Delete(payload);
+        try {
+            signalingClient->sendMessage(motionFrame);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send motion status: %s", e.what());
+        }
     }
 
     void handleSignalingMessage(const SignalingMessage& msg) {
         switch (msg.getType()) {
         case SignalingMessageType::REQUEST:
-            handleStreamRequest(msg);
+            handleRequest(msg);
             break;
         case SignalingMessageType::OFFER:
             handleWebRTCOffer(msg);
             break;
+        case SignalingMessageType::DIAGNOSTICS:
+            handleDiagnosticsRequest(msg, "action", nullptr);
+            break;
+        case SignalingMessageType::LOG:
+            handleLogControl(msg);
+            break;
+        case SignalingMessageType::STREAM_INFO:
+            // Inbound STREAM_INFO is a query; answer from the main loop's
+            // last sample rather than disturbing its smoothing
+            sendStreamInfo(publishedInfo(), &msg);
+            break;
+        case SignalingMessageType::DISCONNECT:
+            // The server reports viewers that went away
+            endViewerSession(msg.getMetadata("viewer_id"));
+            break;
         default:
-            std::cout << "Received unhandled message type: "
-                << signalingMessageTypeToString(msg.getType()) << std::endl;
+            LOG_INFO("Received unhandled message type: %s",
+                signalingMessageTypeToString(msg.getType()));
         }
     }
 
-    void handleStreamRequest(const SignalingMessage& msg) {
-        // Logic to handle stream request
-        SignalingMessage response(SignalingMessageType::RESPONSE, config.deviceId);
+    // Limits bound concurrent work per action, so a burst of one kind is
+    // turned away instead of delaying the others. Tickets held beyond the
+    // handler (streams, snapshots, diag) are bounded in flight; handlers
+    // that answer on the spot are bounded per second.
+    void registerRequestRoutes() {
+        using std::placeholders::_1;
+        using std::placeholders::_2;
+
+        // One slot over the viewer limit, so a full camera still answers
+        // from the capacity model with a relay hint rather than "busy"
+        unsigned int streamSlots = static_cast<unsigned int>(std::max(config.capacity.maxViewers, 0)) + 1;
+        requestRouter.addRoute("stream", kActionStream, streamSlots, 4,
+            std::bind(&DeviceManager::handleStreamRequest, this, _1, _2));
+        requestRouter.addRoute("snapshot", kActionSnapshot, 32, 0,
+            std::bind(&DeviceManager::handleSnapshotRequest, this, _1, _2));
+        requestRouter.addRoute("ptz", kActionPtz, 1, 1,
+            [this](const SignalingMessage& msg, RequestRouter::Ticket) {
+                sendErrorReply(msg, "ptz not supported on this device");
+            });
+        requestRouter.addRoute("config", kActionConfig, 1, 2,
+            [this](const SignalingMessage& msg, RequestRouter::Ticket) { handleConfigRequest(msg); });
+        requestRouter.addRoute("diag", kActionDiag, 1, 0,
+            [this](const SignalingMessage& msg, RequestRouter::Ticket ticket) {
+                handleDiagnosticsRequest(msg, "diag", ticket);
+            });
+    }
+
+    void handleRequest(const SignalingMessage& msg) {
+        switch (requestRouter.dispatch(msg)) {
+        case RequestRouter::Admission::ACCEPTED:
+            break;
+        case RequestRouter::Admission::BUSY:
+            sendErrorReply(msg, "busy");
+            break;
+        case RequestRouter::Admission::UNKNOWN_ACTION:
+            sendErrorReply(msg, "unknown request action");
+            break;
+        }
+    }
+
+    void handleSnapshotRequest(const SignalingMessage& msg, RequestRouter::Ticket ticket) {
+        std::string requestId = msg.getId();
+        std::string viewerId = msg.getMetadata("viewer_id");
+
+        // Answered later from the encoder thread unless the cache is fresh;
+        // the ticket holds the snapshot slot until then
+        snapshotService.request([this, requestId, viewerId, ticket](std::shared_ptr<const Snapshot> snapshot) {
+            sendSnapshot(requestId, viewerId, *snapshot);
+        });
+    }
+
+    void handleConfigRequest(const SignalingMessage& msg) {
+        SignalingMessage response(SignalingMessageType::RESPONSE, messageIds.next().str());
         response.addMetadata("request_id", msg.getId());
 
+        std::string viewerId = msg.getMetadata("viewer_id");
+        if (!viewerId.empty()) {
+            response.addMetadata("viewer_id", std::move(viewerId));
+        }
+
+        // Read-only view; changes arrive as CONFIG_UPDATE
         cJSON* payload = cJSON_CreateObject();
-        cJSON_AddStringToObject(payload, "status", "available");
-        cJSON_AddStringToObject(payload, "stream_url", config.rtspUrl.c_str());
+        cJSON_AddStringToObject(payload, "action", "config");
+        cJSON_AddStringToObject(payload, "device_id", config.deviceId.c_str());
+        cJSON_AddStringToObject(payload, "rtsp_url", config.rtspUrl.c_str());
+        cJSON_AddNumberToObject(payload, "rtp_port", config.defaultRtpPort);
+        cJSON_AddStringToObject(payload, "log_level", logLevelToString(Logger::instance().getLevel()));
+
+        cJSON* stream = cJSON_AddObjectToObject(payload, "stream");
+        cJSON_AddStringToObject(stream, "codec", config.stream.codec.c_str());
+        cJSON_AddNumberToObject(stream, "width", config.stream.width);
+        cJSON_AddNumberToObject(stream, "height", config.stream.height);
+        cJSON_AddNumberToObject(stream, "fps", config.stream.fps);
+        cJSON_AddNumberToObject(stream, "gop", config.stream.gop);
+        cJSON_AddNumberToObject(stream, "bitrate_kbps", config.stream.bitrateKbps);
+
+        cJSON_AddBoolToObject(payload, "motion", config.motion.enabled);
+        cJSON_AddItemToObject(payload, "requests", requestRouter.toJson());
 
         response.setPayload(payload);
+        cJSON_Delete(payload);
 
-        signalingClient->sendMessage(response);
+        try {
+            signalingClient->sendMessage(response);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send config: %s", e.what());
+        }
+    }
 
-        // Free the JSON object
+    void sendSnapshot(const std::string& requestId, const std::string& viewerId, const Snapshot& snapshot) {
+        SignalingMessage response(SignalingMessageType::RESPONSE, messageIds.next().str());
+        response.addMetadata("request_id", requestId);
+        if (!viewerId.empty()) {
+            response.addMetadata("viewer_id", viewerId);
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "type", "snapshot");
+        if (snapshot.error.empty()) {
+            cJSON_AddStringToObject(payload, "status", "ok");
+            cJSON_AddStringToObject(payload, "format", "jpeg");
+            cJSON_AddNumberToObject(payload, "width", snapshot.width);
+            cJSON_AddNumberToObject(payload, "height", snapshot.height);
+            cJSON_AddNumberToObject(payload, "captured_at_ms", static_cast<double>(snapshot.capturedAtMs));
+            cJSON_AddStringToObject(payload, "data", snapshot.jpegBase64.c_str());
+        }
+        else {
+            cJSON_AddStringToObject(payload, "status", "unavailable");
+            cJSON_AddStringToObject(payload, "message", snapshot.error.c_str());
+        }
+        response.setPayload(payload);
         cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(response);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send snapshot: %s", e.what());
+        }
+    }
+
+    void handleStreamRequest(const SignalingMessage& msg, RequestRouter::Ticket ticket) {
+        // Logic to handle stream request
+        SignalingMessage response(SignalingMessageType::RESPONSE, messageIds.next().str());
+        response.addMetadata("request_id", msg.getId());
+
+        // Echo the routing key so the server can deliver the reply
+        std::string viewerId = msg.getMetadata("viewer_id");
+        if (!viewerId.empty()) {
+            response.addMetadata("viewer_id", viewerId);
+        }
+
+        // The session lasts until the viewer's DISCONNECT; a viewer asking
+        // again gives up the one it had
+        std::string sessionKey = viewerId.empty() ? msg.getId() : viewerId;
+        endViewerSession(sessionKey);
+
+        // Degraded viewers get the substream; rejected ones are told to
+        // go through a relay instead
+        AdmissionDecision decision = capacityModel.admit(sessionKey);
+        if (decision != AdmissionDecision::REJECT) {
+            streamStats.viewerJoined();
+            streamTickets[sessionKey] = std::move(ticket);
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        switch (decision) {
+        case AdmissionDecision::ACCEPT:
+            cJSON_AddStringToObject(payload, "status", "available");
+            cJSON_AddStringToObject(payload, "stream_url", config.rtspUrl.c_str());
+            break;
+        case AdmissionDecision::DEGRADE:
+            cJSON_AddStringToObject(payload, "status", "degraded");
+            cJSON_AddStringToObject(payload, "stream_url", config.capacity.substreamUrl.c_str());
+            cJSON_AddNumberToObject(payload, "bitrate_kbps", config.capacity.substreamBitrateKbps);
+            break;
+        case AdmissionDecision::REJECT:
+            cJSON_AddStringToObject(payload, "status", "unavailable");
+            cJSON_AddStringToObject(payload, "reason", "capacity");
+            cJSON_AddBoolToObject(payload, "use_relay", true);
+            LOG_INFO("Stream request %s rejected: device at capacity", msg.getId());
+            break;
+        }
+
+        response.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(response);
+        }
+        catch (const std::exception& e) {
+            // The viewer never learns it was admitted
+            LOG_WARN("Failed to send stream response: %s", e.what());
+            endViewerSession(sessionKey);
+        }
+    }
+
+    // Signaling thread only, like the stream handler
+    void endViewerSession(const std::string& viewerId) {
+        streamTickets.erase(viewerId);
+        if (capacityModel.release(viewerId)) {
+            streamStats.viewerLeft();
+        }
     }
 
     void handleWebRTCOffer(const SignalingMessage& msg) {
         // Placeholder for WebRTC offer processing
         // This would typically involve creating an answer and ICE candidates
-        std::cout << "Received WebRTC offer" << std::endl;
+        LOG_INFO("Received WebRTC offer");
+    }
+
+    StreamInfo publishedInfo() {
+        std::lock_guard<std::mutex> lock(publishedMutex);
+        return publishedStreamInfo;
+    }
+
+    void sendStreamInfo(const StreamInfo& info, const SignalingMessage* request) {
+        SignalingMessage streamInfo(SignalingMessageType::STREAM_INFO, messageIds.next().str());
+
+        if (request) {
+            streamInfo.addMetadata("request_id", request->getId());
+            std::string viewerId = request->getMetadata("viewer_id");
+            if (!viewerId.empty()) {
+                streamInfo.addMetadata("viewer_id", std::move(viewerId));
+            }
+        }
+        else {
+            std::lock_guard<std::mutex> lock(publishedMutex);
+            publishedStreamInfo = info;
+        }
+
+        cJSON* payload = info.toJson();
+        streamInfo.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(streamInfo);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send stream info: %s", e.what());
+        }
+    }
+
+    // Remote log control: {"level": "...", "stream": bool, "stream_level": "..."}
+    void handleLogControl(const SignalingMessage& msg) {
+        cJSON* request = msg.getPayload();
+        cJSON* level = cJSON_GetObjectItemCaseSensitive(request, "level");
+        cJSON* stream = cJSON_GetObjectItemCaseSensitive(request, "stream");
+        cJSON* streamLevel = cJSON_GetObjectItemCaseSensitive(request, "stream_level");
+
+        LogLevel parsed;
+        if (cJSON_IsString(level) && stringToLogLevel(level->valuestring, parsed)) {
+            Logger::instance().setLevel(parsed);
+        }
+
+        if (cJSON_IsBool(stream)) {
+            if (cJSON_IsTrue(stream)) {
+                LogLevel minStreamLevel = LogLevel::WARN;
+                if (cJSON_IsString(streamLevel)) {
+                    stringToLogLevel(streamLevel->valuestring, minStreamLevel);
+                }
+
+                // Batches go back to whoever asked for them
+                std::string viewerId = msg.getMetadata("viewer_id");
+                Logger::instance().setStream(
+                    [this, viewerId](std::vector<std::string>&& lines) {
+                        sendLogBatch(viewerId, lines);
+                    },
+                    minStreamLevel);
+            }
+            else {
+                Logger::instance().clearStream();
+            }
+        }
+
+        cJSON_Delete(request);
+    }
+
+    // Runs on the logger's flusher thread
+    void sendLogBatch(const std::string& viewerId, const std::vector<std::string>& lines) {
+        // Streaming is the first thing to go under memory pressure
+        if (!signalingClient->isConnected() || MemoryAccounting::underPressure()) {
+            return;
+        }
+
+        SignalingMessage logMsg(SignalingMessageType::LOG, messageIds.next().str());
+        if (!viewerId.empty()) {
+            logMsg.addMetadata("viewer_id", viewerId);
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON* entries = cJSON_AddArrayToObject(payload, "lines");
+        for (const auto& line : lines) {
+            cJSON_AddItemToArray(entries, cJSON_CreateString(line.c_str()));
+        }
+        logMsg.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(logMsg);
+        }
+        catch (const std::exception&) {
+            // Logging the failure would feed straight back into the stream
+        }
+    }
+
+    // kindKey names the payload field holding the diagnostic to run:
+    // "action" on DIAGNOSTICS messages, "diag" on REQUEST {"action": "diag"}
+    void handleDiagnosticsRequest(const SignalingMessage& msg, const char* kindKey,
+        RequestRouter::Ticket ticket) {
+        cJSON* request = msg.getPayload();
+        cJSON* action = cJSON_GetObjectItemCaseSensitive(request, kindKey);
+        cJSON* duration = cJSON_GetObjectItemCaseSensitive(request, "duration");
+        cJSON* hz = cJSON_GetObjectItemCaseSensitive(request, "hz");
+
+        bool isProfile = cJSON_IsString(action) && strcmp(action->valuestring, "profile") == 0;
+        bool isMemory = cJSON_IsString(action) && strcmp(action->valuestring, "memory") == 0;
+        int durationSecs = cJSON_IsNumber(duration) ? duration->valueint : 5;
+        int frequencyHz = cJSON_IsNumber(hz) ? hz->valueint : 99;
+        cJSON_Delete(request);
+
+        if (isMemory) {
+            sendMemoryReport(msg);
+            return;
+        }
+
+        if (!isProfile) {
+            sendErrorReply(msg, "unsupported diagnostics action");
+            return;
+        }
+
+        // A profile report can run to hundreds of kB of JSON
+        if (MemoryAccounting::underPressure()) {
+            sendErrorReply(msg, "memory budget exceeded");
+            return;
+        }
+
+        // One profile at a time; sampling never runs on the lws thread
+        bool expected = false;
+        if (!diagnosticsBusy.compare_exchange_strong(expected, true)) {
+            sendErrorReply(msg, "profile already running");
+            return;
+        }
+
+        if (diagnosticsThread.joinable()) {
+            diagnosticsThread.join();
+        }
+
+        std::string requestId = msg.getId();
+        std::string viewerId = msg.getMetadata("viewer_id");
+        diagnosticsThread = std::thread([this, requestId, viewerId, durationSecs, frequencyHz, ticket]() {
+            config.diagnosticsThread.apply();
+            SamplingProfiler::Profile profile;
+            if (SamplingProfiler::collect(durationSecs, frequencyHz, profile)) {
+                sendProfile(requestId, viewerId, profile);
+            }
+            else {
+                sendErrorReply(requestId, viewerId, "profiler unavailable");
+            }
+            diagnosticsBusy = false;
+        });
+    }
+
+    void sendProfile(const std::string& requestId, const std::string& viewerId,
+        const SamplingProfiler::Profile& profile) {
+        cJSON* report = SamplingProfiler::toJson(profile);
+        char* reportStr = cJSON_PrintUnformatted(report);
+        cJSON_Delete(report);
+        if (!reportStr) {
+            return;
+        }
+        std::string encoded(reportStr);
+        cJSON_free(reportStr);
+
+        // Keep each message well below typical websocket frame limits
+        const size_t chunkSize = 16 * 1024;
+        size_t chunks = (encoded.size() + chunkSize - 1) / chunkSize;
+
+        for (size_t i = 0; i < chunks; i++) {
+            SignalingMessage chunk(SignalingMessageType::DIAGNOSTICS, messageIds.next().str());
+            chunk.addMetadata("request_id", requestId);
+            if (!viewerId.empty()) {
+                chunk.addMetadata("viewer_id", viewerId);
+            }
+
+            cJSON* payload = cJSON_CreateObject();
+            cJSON_AddStringToObject(payload, "kind", "profile");
+            cJSON_AddNumberToObject(payload, "chunk", static_cast<double>(i));
+            cJSON_AddNumberToObject(payload, "chunks", static_cast<double>(chunks));
+            cJSON_AddStringToObject(payload, "data", encoded.substr(i * chunkSize, chunkSize).c_str());
+            chunk.setPayload(payload);
+            cJSON_Delete(payload);
+
+            try {
+                signalingClient->sendMessage(chunk);
+            }
+            catch (const std::exception& e) {
+                LOG_WARN("Failed to send profile chunk: %s", e.what());
+                return;
+            }
+        }
+    }
+
+    void sendMemoryReport(const SignalingMessage& msg) {
+        SignalingMessage report(SignalingMessageType::DIAGNOSTICS, messageIds.next().str());
+        report.addMetadata("request_id", msg.getId());
+
+        std::string viewerId = msg.getMetadata("viewer_id");
+        if (!viewerId.empty()) {
+            report.addMetadata("viewer_id", std::move(viewerId));
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "kind", "memory");
+        cJSON_AddItemToObject(payload, "data", MemoryAccounting::toJson());
+        report.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(report);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send memory report: %s", e.what());
+        }
+    }
+
+    void sendErrorReply(const SignalingMessage& msg, const char* reason) {
+        sendErrorReply(msg.getId(), msg.getMetadata("viewer_id"), reason);
+    }
+
+    void sendErrorReply(const std::string& requestId, const std::string& viewerId, const char* reason) {
+        SignalingMessage error(SignalingMessageType::ERROR, messageIds.next().str());
+        error.addMetadata("request_id", requestId);
+        if (!viewerId.empty()) {
+            error.addMetadata("viewer_id", viewerId);
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "message", reason);
+        error.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            signalingClient->sendMessage(error);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send error reply: %s", e.what());
+        }
     }
 
     // System information helpers (mock implementations)
@@ -170,21 +894,492 @@ private:
     }
 };
 
-int main() {
+
+// Gateway relay mode.
+//
+// Viewers address the relay as if it were a camera (OFFER with the camera
+// id as "source"); the relay opens one session per camera by sending its
+// own OFFER upstream as a viewer, then forwards that camera's RTP to every
+// viewer that asked for it. Cameras see an ordinary viewer and need no
+// changes. Media is plain RTP over UDP: candidates are {"address", "port"}.
+//
+// A camera that encodes simulcast or temporal layers lists them in its
+// ANSWER ({"layers": [{"ssrc", "kbps"}, ...], "framemarking_id": n});
+// viewers state "max_kbps" / "max_temporal" in OFFER or ICE and get the
+// layers that fit.
+class RelayGateway {
+private:
+    DeviceConfig config;
+    MessageIdGenerator messageIds;
+
+    // Registered as a relay; viewers address their OFFERs to it
+    std::unique_ptr<SignalingClient> downstream;
+
+    // Registered as a viewer; carries our OFFERs to the cameras
+    std::unique_ptr<SignalingClient> upstream;
+
+    RtpRelay relay;
+    std::string advertisedAddress;
+
+    // Upstream OFFER id -> camera, to match the camera's reply
+    struct PendingOffer {
+        std::string sourceId;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+    std::mutex pendingMutex;
+    std::map<std::string, PendingOffer> pendingOffers;
+
+public:
+    RelayGateway(const std::string& configPath, const std::string& signalingUrl)
+        : config(DeviceConfig::loadFromFile(configPath)),
+        messageIds(config.deviceId),
+        downstream(new SignalingClient(signalingUrl)),
+        upstream(new SignalingClient(signalingUrl)),
+        relay(config.relay),
+        advertisedAddress(config.relay.publicAddress.empty() ?
+            config.relay.bindAddress : config.relay.publicAddress) {
+
+        LogLevel level;
+        if (stringToLogLevel(config.logLevel, level)) {
+            Logger::instance().setLevel(level);
+        }
+        if (!config.logFile.empty() && !Logger::instance().setOutputFile(config.logFile)) {
+            LOG_WARN("Could not open log file %s, using stderr", config.logFile);
+        }
+
+        config.mainThread.apply();
+        Logger::instance().setThreadPolicy(config.logThread);
+        downstream->setThreadPolicy(config.signalingThread);
+        ThreadPolicy upstreamPolicy = config.signalingThread;
+        upstreamPolicy.name = "rtc-upstream";
+        upstream->setThreadPolicy(upstreamPolicy);
+
+        MemoryAccounting::setBudget(MemoryTag::JSON, static_cast<size_t>(config.memory.jsonKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::WEBSOCKET, static_cast<size_t>(config.memory.websocketKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::QUEUES, static_cast<size_t>(config.memory.queuesKb) * 1024);
+        MemoryAccounting::setBudget(MemoryTag::PACKETS, static_cast<size_t>(config.memory.packetsKb) * 1024);
+
+        downstream->setReliableDelivery(true);
+        upstream->setReliableDelivery(true);
+        if (!config.capture.path.empty()) {
+            size_t fileBytes = static_cast<size_t>(config.capture.fileKb) * 1024;
+            downstream->setCapture(config.capture.path + "-downstream", fileBytes, config.capture.files);
+            upstream->setCapture(config.capture.path + "-upstream", fileBytes, config.capture.files);
+        }
+
+        downstream->setMessageCallback(
+            std::bind(&RelayGateway::handleViewerMessage, this, std::placeholders::_1));
+        upstream->setMessageCallback(
+            std::bind(&RelayGateway::handleCameraMessage, this, std::placeholders::_1));
+    }
+
+    bool initialize() {
+        if (!downstream->connect() || !upstream->connect()) {
+            LOG_ERROR("Failed to connect to signaling server");
+            return false;
+        }
+
+        downstream->startEventLoop();
+        upstream->startEventLoop();
+
+        sendRegistration(*downstream, "relay");
+        sendRegistration(*upstream, "viewer");
+
+        std::string hangReport;
+        if (Watchdog::takeReport(config.hangReportPath, hangReport)) {
+            LOG_WARN("Recovered from a hang:");
+            Logger::instance().logLines(LogLevel::WARN, hangReport);
+        }
+        Watchdog::instance().start(config.watchdogTimeoutMs, config.hangReportPath);
+
+        relay.start(config.relayThread);
+        LOG_INFO("Relay mode: forwarding on %s ports %d-%d", advertisedAddress,
+            config.relay.portBase, config.relay.portBase + config.relay.portCount - 1);
+        return true;
+    }
+
+    void run() {
+        const int heartbeatIntervalSecs = 30;
+        int ticks = 0;
+        WatchdogLease watchdog("rtc-main");
+
+        while (g_running) {
+            watchdog.kick();
+
+            if (ticks % heartbeatIntervalSecs == 0) {
+                sendHeartbeat();
+            }
+            expirePendingOffers();
+
+            ticks++;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        Watchdog::instance().stop();
+        relay.stop();
+        upstream->disconnect();
+        downstream->disconnect();
+    }
+
+private:
+    void sendRegistration(SignalingClient& client, const char* deviceType) {
+        SignalingMessage registrationMsg(SignalingMessageType::REGISTER, messageIds.next().str());
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "device_id", config.deviceId.c_str());
+        cJSON_AddStringToObject(payload, "device_type", deviceType);
+        registrationMsg.setPayload(payload);
+        cJSON_Delete(payload);
+
+        registrationMsg.addMetadata("version", "1.0.0");
+        registrationMsg.addMetadata("id_format", "base32");
+        client.sendMessage(registrationMsg);
+    }
+
+    void sendHeartbeat() {
+        SignalingMessage heartbeat(SignalingMessageType::HEARTBEAT, messageIds.next().str());
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddItemToObject(payload, "relay", relay.toJson());
+        cJSON_AddItemToObject(payload, "memory", MemoryAccounting::toJson());
+        cJSON_AddItemToObject(payload, "link", downstream->getLinkStats().toJson());
+        heartbeat.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            downstream->sendMessage(heartbeat);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Failed to send heartbeat: %s", e.what());
+        }
+    }
+
+    // {"candidate": {"address": "192.0.2.7", "port": 5004}}
+    static bool candidateField(const cJSON* payload, RelayEndpoint& endpoint) {
+        cJSON* candidate = cJSON_GetObjectItemCaseSensitive(payload, "candidate");
+        cJSON* address = cJSON_GetObjectItemCaseSensitive(candidate, "address");
+        cJSON* port = cJSON_GetObjectItemCaseSensitive(candidate, "port");
+        return cJSON_IsString(address) && cJSON_IsNumber(port) &&
+            port->valueint > 0 && port->valueint < 65536 &&
+            RelayEndpoint::resolve(address->valuestring, static_cast<uint16_t>(port->valueint), endpoint);
+    }
+
+    static cJSON* candidateJson(const std::string& address, uint16_t port) {
+        cJSON* candidate = cJSON_CreateObject();
+        cJSON_AddStringToObject(candidate, "address", address.c_str());
+        cJSON_AddNumberToObject(candidate, "port", port);
+        return candidate;
+    }
+
+    // Viewer side
+    void handleViewerMessage(const SignalingMessage& msg) {
+        switch (msg.getType()) {
+        case SignalingMessageType::OFFER:
+        case SignalingMessageType::ICE:
+            handleViewerOffer(msg);
+            break;
+        case SignalingMessageType::DISCONNECT:
+            handleViewerDisconnect(msg);
+            break;
+        default:
+            LOG_DEBUG("Relay: ignoring %s from viewer",
+                signalingMessageTypeToString(msg.getType()));
+        }
+    }
+
+    // OFFER attaches a viewer; ICE with a new candidate moves it
+    void handleViewerOffer(const SignalingMessage& msg) {
+        std::string viewerId = msg.getMetadata("viewer_id");
+
+        cJSON* payload = msg.getPayload();
+        cJSON* source = cJSON_GetObjectItemCaseSensitive(payload, "source");
+        std::string sourceId = cJSON_IsString(source) ? source->valuestring : "";
+        RelayEndpoint endpoint;
+        bool haveCandidate = candidateField(payload, endpoint);
+        cJSON* maxKbps = cJSON_GetObjectItemCaseSensitive(payload, "max_kbps");
+        cJSON* maxTemporal = cJSON_GetObjectItemCaseSensitive(payload, "max_temporal");
+        bool haveLimits = cJSON_IsNumber(maxKbps) || cJSON_IsNumber(maxTemporal);
+        int kbpsLimit = cJSON_IsNumber(maxKbps) ? maxKbps->valueint : 0;
+        int temporalLimit = cJSON_IsNumber(maxTemporal) ? maxTemporal->valueint : -1;
+        cJSON_Delete(payload);
+
+        if (viewerId.empty() || sourceId.empty() || !haveCandidate) {
+            sendViewerError(msg, "offer needs source and candidate");
+            return;
+        }
+
+        // First viewer of a camera opens the upstream session
+        bool opened = !relay.hasSource(sourceId);
+        uint16_t port = relay.addSource(sourceId);
+        if (port == 0) {
+            sendViewerError(msg, "relay has no free ports");
+            return;
+        }
+        if (opened && !sendCameraOffer(sourceId, port)) {
+            relay.removeSource(sourceId);
+            sendViewerError(msg, "camera unreachable");
+            return;
+        }
+
+        std::string previousSource;
+        size_t previousRemaining = 0;
+        uint32_t ssrc = relay.addViewer(sourceId, viewerId, endpoint, previousSource, previousRemaining);
+        if (!previousSource.empty() && previousRemaining == 0) {
+            closeSource(previousSource);
+        }
+        if (ssrc == 0) {
+            // Don't leave a source we just opened with nobody watching
+            if (opened) {
+                closeSource(sourceId);
+            }
+            sendViewerError(msg, "relay full for this source");
+            return;
+        }
+        if (haveLimits) {
+            relay.setViewerLimits(viewerId, kbpsLimit, temporalLimit);
+        }
+
+        if (msg.getType() == SignalingMessageType::OFFER) {
+            SignalingMessage answer(SignalingMessageType::ANSWER, messageIds.next().str());
+            answer.addMetadata("request_id", msg.getId());
+            answer.addMetadata("viewer_id", viewerId);
+
+            cJSON* answerPayload = cJSON_CreateObject();
+            cJSON_AddStringToObject(answerPayload, "source", sourceId.c_str());
+            cJSON_AddNumberToObject(answerPayload, "ssrc", ssrc);
+            cJSON_AddItemToObject(answerPayload, "candidate", candidateJson(advertisedAddress, port));
+
+            uint32_t fecSsrc = relay.fecSsrc(sourceId);
+            if (fecSsrc != 0) {
+                cJSON* fec = cJSON_AddObjectToObject(answerPayload, "fec");
+                cJSON_AddStringToObject(fec, "scheme", "flexfec");
+                cJSON_AddNumberToObject(fec, "ssrc", fecSsrc);
+                cJSON_AddNumberToObject(fec, "payload_type", config.relay.fecPayloadType);
+            }
+            answer.setPayload(answerPayload);
+            cJSON_Delete(answerPayload);
+
+            try {
+                downstream->sendMessage(answer);
+            }
+            catch (const std::exception& e) {
+                LOG_WARN("Relay: failed to send answer to viewer %s: %s", viewerId, e.what());
+            }
+        }
+    }
+
+    void handleViewerDisconnect(const SignalingMessage& msg) {
+        std::string sourceId;
+        size_t remaining = 0;
+        if (relay.removeViewer(msg.getMetadata("viewer_id"), sourceId, remaining) && remaining == 0) {
+            closeSource(sourceId);
+        }
+    }
+
+    void sendViewerError(const SignalingMessage& msg, const char* reason) {
+        SignalingMessage error(SignalingMessageType::ERROR, messageIds.next().str());
+        error.addMetadata("request_id", msg.getId());
+        error.addMetadata("viewer_id", msg.getMetadata("viewer_id"));
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "message", reason);
+        error.setPayload(payload);
+        cJSON_Delete(payload);
+
+        try {
+            downstream->sendMessage(error);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Relay: failed to send error to viewer %s: %s", msg.getMetadata("viewer_id"), e.what());
+        }
+    }
+
+    // Camera side
+    bool sendCameraOffer(const std::string& sourceId, uint16_t port) {
+        SignalingMessage offer(SignalingMessageType::OFFER, messageIds.next().str());
+        offer.addMetadata("device_id", sourceId);
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddBoolToObject(payload, "relay", true);
+        cJSON_AddItemToObject(payload, "candidate", candidateJson(advertisedAddress, port));
+        offer.setPayload(payload);
+        cJSON_Delete(payload);
+
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingOffers[offer.getId()] = PendingOffer{ sourceId, std::chrono::steady_clock::now() };
+        }
+
+        try {
+            upstream->sendMessage(offer);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Relay: failed to send offer to camera %s: %s", sourceId, e.what());
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingOffers.erase(offer.getId());
+            return false;
+        }
+        return true;
+    }
+
+    void handleCameraMessage(const SignalingMessage& msg) {
+        std::string sourceId;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto pending = pendingOffers.find(msg.getMetadata("request_id"));
+            if (pending != pendingOffers.end()) {
+                sourceId = pending->second.sourceId;
+                pendingOffers.erase(pending);
+            }
+        }
+
+        switch (msg.getType()) {
+        case SignalingMessageType::ANSWER:
+            LOG_INFO("Relay: camera %s answered", msg.getMetadata("device_id"));
+            if (!sourceId.empty()) {
+                applyCameraLayers(sourceId, msg);
+            }
+            break;
+        case SignalingMessageType::ERROR:
+            // Camera offline or refused: its viewers will get nothing
+            if (!sourceId.empty()) {
+                LOG_WARN("Relay: camera %s unavailable", sourceId);
+                closeSource(sourceId);
+            }
+            break;
+        case SignalingMessageType::DISCONNECT:
+            closeSource(msg.getMetadata("device_id"));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // A camera that never answers would leave its viewers waiting forever
+    void expirePendingOffers() {
+        std::vector<std::string> expired;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            for (auto it = pendingOffers.begin(); it != pendingOffers.end();) {
+                if (now - it->second.sentAt > kCameraAnswerTimeout) {
+                    expired.push_back(it->second.sourceId);
+                    it = pendingOffers.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        for (const std::string& sourceId : expired) {
+            LOG_WARN("Relay: camera %s did not answer", sourceId);
+            closeSource(sourceId);
+        }
+    }
+
+    void applyCameraLayers(const std::string& sourceId, const SignalingMessage& answer) {
+        cJSON* payload = answer.getPayload();
+        cJSON* layers = cJSON_GetObjectItemCaseSensitive(payload, "layers");
+        cJSON* frameMarking = cJSON_GetObjectItemCaseSensitive(payload, "framemarking_id");
+
+        std::vector<RelayLayer> declared;
+        cJSON* layer;
+        cJSON_ArrayForEach(layer, layers) {
+            cJSON* ssrc = cJSON_GetObjectItemCaseSensitive(layer, "ssrc");
+            cJSON* kbps = cJSON_GetObjectItemCaseSensitive(layer, "kbps");
+            if (cJSON_IsNumber(ssrc) && cJSON_IsNumber(kbps)) {
+                RelayLayer entry;
+                entry.ssrc = static_cast<uint32_t>(ssrc->valuedouble);
+                entry.kbps = kbps->valueint;
+                declared.push_back(entry);
+            }
+        }
+        int frameMarkingId = cJSON_IsNumber(frameMarking) ? frameMarking->valueint : 0;
+        cJSON_Delete(payload);
+
+        // Lowest first, whatever order the camera listed them in
+        std::sort(declared.begin(), declared.end(),
+            [](const RelayLayer& a, const RelayLayer& b) { return a.kbps < b.kbps; });
+
+        if (!declared.empty() || frameMarkingId != 0) {
+            relay.setSourceLayers(sourceId, declared, frameMarkingId);
+        }
+    }
+
+    // Tell the camera and any remaining viewers that the session is over
+    void closeSource(const std::string& sourceId) {
+        if (sourceId.empty() || !relay.hasSource(sourceId)) {
+            return;
+        }
+
+        for (const std::string& viewerId : relay.removeSource(sourceId)) {
+            SignalingMessage bye(SignalingMessageType::DISCONNECT, messageIds.next().str());
+            bye.addMetadata("viewer_id", viewerId);
+
+            cJSON* payload = cJSON_CreateObject();
+            cJSON_AddStringToObject(payload, "source", sourceId.c_str());
+            bye.setPayload(payload);
+            cJSON_Delete(payload);
+
+            try {
+                downstream->sendMessage(bye);
+            }
+            catch (const std::exception& e) {
+                LOG_WARN("Relay: failed to send disconnect to viewer %s: %s", viewerId, e.what());
+            }
+        }
+
+        SignalingMessage bye(SignalingMessageType::DISCONNECT, messageIds.next().str());
+        bye.addMetadata("device_id", sourceId);
+        try {
+            upstream->sendMessage(bye);
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("Relay: failed to send disconnect to camera %s: %s", sourceId, e.what());
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    // A hung device re-executes itself with the same arguments
+    Watchdog::instance().setRestartCommand(argc, argv);
+
     // Register signal handlers
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
 
+    // Before anything touches cJSON or libwebsockets
+    MemoryAccounting::install();
+
+    // Background log flusher; nothing below formats on the caller's thread
+    Logger::instance().start();
+
+    const char* configPath = "/etc/kinnode/config.json";
+    const char* signalingUrl = "ws://192.30.240.10:8080";
+
     try {
+        // Same binary on a site gateway: forward instead of capture
+        if (DeviceConfig::loadFromFile(configPath).relay.enabled) {
+            RelayGateway gateway(configPath, signalingUrl);
+            if (!gateway.initialize()) {
+                LOG_ERROR("Relay initialization failed");
+                Logger::instance().stop();
+                return 1;
+            }
+
+            gateway.run();
+            Logger::instance().stop();
+            return 0;
+        }
+
         // Create device manager
-        DeviceManager deviceManager(
-            "/etc/kinnode/config.json",  // Config path
-            "ws://192.30.240.10:8080"    // Signaling server URL
-        );
+        DeviceManager deviceManager(configPath, signalingUrl);
 
         // Initialize device
         if (!deviceManager.initialize()) {
-            std::cerr << "Device initialization failed\n";
+            LOG_ERROR("Device initialization failed");
+            Logger::instance().stop();
             return 1;
         }
 
@@ -192,9 +1387,11 @@ int main() {
         deviceManager.run();
     }
     catch (const std::exception& e) {
-        std::cerr << "Fatal error: " << e.what() << std::endl;
+        LOG_ERROR("Fatal error: %s", e.what());
+        Logger::instance().stop();
         return 1;
     }
 
+    Logger::instance().stop();
     return 0;
 }
\ No newline at end of file
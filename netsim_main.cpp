@@ -0,0 +1,583 @@
+// src/netsim_main.cpp
+//
+// Network impairment harness.
+//
+//   netsim simulate <scenario.json>
+//       Synthetic video (the scenario's "media" block) through the scripted
+//       link on a simulated clock. Same scenario, same output, so runs can
+//       be compared and gated on.
+//
+//   netsim udp <listen-port> <target-address> <target-port> <scenario.json>
+//       Real-time UDP proxy for a media path, e.g. camera -> relay. The
+//       first party to send becomes the client; replies go back to it
+//       through a second link with the same conditions. On exit prints
+//       quality metrics for the first video stream forwarded.
+//
+//   netsim tcp <listen-port> <target-address> <target-port> <scenario.json>
+//       Real-time TCP proxy for signaling. Delay, jitter and bandwidth
+//       apply per segment; loss is left to TCP. An outage ("down") drops
+//       every open connection and refuses new ones until it ends, which
+//       exercises the client's reconnect path.
+//
+// Proxies run for the scenario's duration_ms or until interrupted.
+#include <iostream>
+#include <csignal>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "NetworkImpairment.h"
+#include "RtpPacket.h"
+#include "Logger.h"
+
+// Global signal handling
+namespace {
+    std::atomic<bool> g_running(true);
+
+    const size_t kMaxDatagram = 65536;
+    const size_t kSegmentSize = 1448;
+    const size_t kPacketPayload = 1200;
+    const int kKeyframeScale = 4;               // Keyframe size over a delta frame
+    const uint32_t kVideoClockRate = 90000;
+    const int kMaxPollMs = 20;
+    const size_t kMaxTcpConnections = 64;
+
+    // Derives the reverse-direction seed
+    const uint64_t kReverseSeed = 0x9E3779B97F4A7C15ull;
+
+    int64_t wallMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool parseAddress(const char* host, const char* port, sockaddr_in& address) {
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        int value = atoi(port);
+        address.sin_port = htons(static_cast<uint16_t>(value));
+        return value > 0 && value < 65536 && inet_pton(AF_INET, host, &address.sin_addr) == 1;
+    }
+
+    int bindSocket(int type, uint16_t port) {
+        int fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            (type == SOCK_STREAM && listen(fd, 16) != 0)) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void printJson(cJSON* json) {
+        char* text = cJSON_Print(json);
+        if (text) {
+            std::cout << text << std::endl;
+            free(text);
+        }
+        cJSON_Delete(json);
+    }
+
+    cJSON* linkJson(const ImpairedLink& link) {
+        cJSON* json = cJSON_CreateObject();
+        cJSON_AddNumberToObject(json, "sent", static_cast<double>(link.getSent()));
+        cJSON_AddNumberToObject(json, "dropped", static_cast<double>(link.getDropped()));
+        return json;
+    }
+}
+
+void signalHandler(int signum) {
+    std::cerr << "Interrupt signal (" << signum << ") received.\n";
+    g_running = false;
+}
+
+// Simulated clock
+static int runSimulation(const Scenario& scenario) {
+    ImpairedLink link(scenario.seed);
+    MediaMetrics metrics;
+
+    // Frame sizes vary +/-20% around a GOP that averages the bitrate
+    std::mt19937_64 sizes(scenario.seed ^ kReverseSeed);
+    std::uniform_real_distribution<double> variation(0.8, 1.2);
+    double meanFrame = scenario.bitrateKbps * 1000.0 / 8.0 / scenario.fps;
+    double deltaFrame = meanFrame * scenario.gop / (scenario.gop - 1 + kKeyframeScale);
+
+    int64_t frameUs = 1000000 / scenario.fps;
+    int64_t endUs = scenario.durationMs * 1000;
+    uint32_t timestampStep = kVideoClockRate / scenario.fps;
+
+    uint32_t frame = 0;
+    for (int64_t nowUs = 0; nowUs < endUs; nowUs += frameUs, frame++) {
+        link.setProfile(scenario.profileAt(nowUs / 1000));
+
+        bool keyframe = frame % scenario.gop == 0;
+        size_t bytes = static_cast<size_t>(deltaFrame * (keyframe ? kKeyframeScale : 1) * variation(sizes));
+        uint32_t timestamp = frame * timestampStep;
+
+        for (size_t offset = 0; offset < bytes; offset += kPacketPayload) {
+            size_t payload = std::min(kPacketPayload, bytes - offset);
+            metrics.packetSent(timestamp, nowUs, keyframe);
+
+            int64_t arrivalUs = link.transmit(nowUs, payload + RtpPacketView::kFixedHeaderSize);
+            if (arrivalUs >= 0) {
+                metrics.packetArrived(timestamp, arrivalUs);
+            }
+        }
+    }
+
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "seed", static_cast<double>(scenario.seed));
+    cJSON_AddNumberToObject(json, "duration_ms", static_cast<double>(scenario.durationMs));
+    cJSON_AddItemToObject(json, "media", metrics.toJson());
+    cJSON_AddItemToObject(json, "link", linkJson(link));
+    printJson(json);
+    return 0;
+}
+
+// UDP proxy
+namespace {
+    struct Datagram {
+        int64_t dueUs;
+        uint64_t order;                 // Ties keep send order
+        bool toTarget;
+        bool tracked;
+        uint32_t timestamp;
+        std::vector<uint8_t> data;
+
+        bool operator>(const Datagram& other) const {
+            return dueUs != other.dueUs ? dueUs > other.dueUs : order > other.order;
+        }
+    };
+}
+
+static int runUdpProxy(const Scenario& scenario, uint16_t listenPort, const sockaddr_in& target) {
+    int clientFd = bindSocket(SOCK_DGRAM, listenPort);
+    int targetFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (clientFd < 0 || targetFd < 0 ||
+        connect(targetFd, reinterpret_cast<const sockaddr*>(&target), sizeof(target)) != 0) {
+        LOG_ERROR("Could not open UDP proxy sockets: %s", strerror(errno));
+        return 1;
+    }
+
+    ImpairedLink forward(scenario.seed);
+    ImpairedLink reverse(scenario.seed ^ kReverseSeed);
+    MediaMetrics metrics;
+
+    std::priority_queue<Datagram, std::vector<Datagram>, std::greater<Datagram>> pending;
+    uint64_t order = 0;
+    sockaddr_in client;
+    socklen_t clientLength = 0;
+
+    // Only the first stream that shows a keyframe is measured
+    bool haveVideo = false;
+    uint32_t videoSsrc = 0;
+
+    std::vector<uint8_t> buffer(kMaxDatagram);
+    int64_t startUs = wallMicros();
+    const LinkProfile* profile = nullptr;
+
+    while (g_running) {
+        int64_t nowUs = wallMicros();
+        int64_t elapsedMs = (nowUs - startUs) / 1000;
+        if (elapsedMs >= scenario.durationMs) {
+            break;
+        }
+
+        const LinkProfile* current = &scenario.profileAt(elapsedMs);
+        if (current != profile) {
+            profile = current;
+            forward.setProfile(*profile);
+            reverse.setProfile(*profile);
+        }
+
+        // Deliver whatever is due
+        while (!pending.empty() && pending.top().dueUs <= nowUs) {
+            const Datagram& datagram = pending.top();
+            if (datagram.toTarget) {
+                send(targetFd, datagram.data.data(), datagram.data.size(), 0);
+                if (datagram.tracked) {
+                    metrics.packetArrived(datagram.timestamp, nowUs);
+                }
+            }
+            else if (clientLength > 0) {
+                sendto(clientFd, datagram.data.data(), datagram.data.size(), 0,
+                    reinterpret_cast<const sockaddr*>(&client), clientLength);
+            }
+            pending.pop();
+        }
+
+        int timeoutMs = kMaxPollMs;
+        if (!pending.empty()) {
+            timeoutMs = static_cast<int>(std::min<int64_t>(timeoutMs,
+                std::max<int64_t>(0, (pending.top().dueUs - nowUs) / 1000)));
+        }
+
+        pollfd fds[2] = { { clientFd, POLLIN, 0 }, { targetFd, POLLIN, 0 } };
+        if (poll(fds, 2, timeoutMs) <= 0) {
+            continue;
+        }
+        nowUs = wallMicros();
+
+        // Client -> target
+        for (;;) {
+            sockaddr_in from;
+            socklen_t fromLength = sizeof(from);
+            ssize_t n = recvfrom(clientFd, buffer.data(), buffer.size(), 0,
+                reinterpret_cast<sockaddr*>(&from), &fromLength);
+            if (n < 0) {
+                break;
+            }
+            client = from;
+            clientLength = fromLength;
+
+            Datagram datagram;
+            datagram.toTarget = true;
+            datagram.tracked = false;
+            datagram.timestamp = 0;
+
+            RtpPacketView packet;
+            if (packet.parse(buffer.data(), static_cast<size_t>(n), 0)) {
+                if (!haveVideo && packet.keyframe()) {
+                    haveVideo = true;
+                    videoSsrc = packet.ssrc;
+                }
+                if (haveVideo && packet.ssrc == videoSsrc) {
+                    datagram.tracked = true;
+                    datagram.timestamp = packet.timestamp;
+                    metrics.packetSent(packet.timestamp, nowUs, packet.keyframe());
+                }
+            }
+
+            datagram.dueUs = forward.transmit(nowUs, static_cast<size_t>(n));
+            if (datagram.dueUs >= 0) {
+                datagram.order = order++;
+                datagram.data.assign(buffer.begin(), buffer.begin() + n);
+                pending.push(std::move(datagram));
+            }
+        }
+
+        // Target -> client
+        for (;;) {
+            ssize_t n = recv(targetFd, buffer.data(), buffer.size(), 0);
+            if (n < 0) {
+                break;
+            }
+
+            Datagram datagram;
+            datagram.dueUs = reverse.transmit(nowUs, static_cast<size_t>(n));
+            if (datagram.dueUs >= 0) {
+                datagram.order = order++;
+                datagram.toTarget = false;
+                datagram.tracked = false;
+                datagram.timestamp = 0;
+                datagram.data.assign(buffer.begin(), buffer.begin() + n);
+                pending.push(std::move(datagram));
+            }
+        }
+    }
+
+    close(clientFd);
+    close(targetFd);
+
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddItemToObject(json, "media", metrics.toJson());
+    cJSON_AddItemToObject(json, "forward", linkJson(forward));
+    cJSON_AddItemToObject(json, "reverse", linkJson(reverse));
+    printJson(json);
+    return 0;
+}
+
+// TCP proxy
+namespace {
+    struct Segment {
+        int64_t dueUs;
+        std::vector<uint8_t> data;
+        size_t offset;
+    };
+
+    // One direction of a proxied connection
+    struct Pipe {
+        int from;
+        int to;
+        ImpairedLink link;
+        std::deque<Segment> queue;
+
+        Pipe(int source, int sink, uint64_t seed) : from(source), to(sink), link(seed) {}
+    };
+
+    struct Connection {
+        int clientFd;
+        int targetFd;
+        std::unique_ptr<Pipe> up;
+        std::unique_ptr<Pipe> down;
+        bool closed;
+    };
+
+    // TCP retransmits what the path loses, so only timing applies
+    LinkProfile streamProfile(const LinkProfile& profile) {
+        LinkProfile stream = profile;
+        stream.loss = 0.0;
+        stream.reorder = 0.0;
+        stream.down = false;            // Outages close the connection instead
+        return stream;
+    }
+
+    // Reads what is available into timed segments; false on close
+    bool readPipe(Pipe& pipe, int64_t nowUs) {
+        uint8_t buffer[kSegmentSize];
+        for (;;) {
+            ssize_t n = recv(pipe.from, buffer, sizeof(buffer), 0);
+            if (n == 0) {
+                return false;
+            }
+            if (n < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+
+            // Queue overflow does not drop bytes on a stream; it waits
+            int64_t dueUs = pipe.link.transmit(nowUs, static_cast<size_t>(n));
+            while (dueUs < 0) {
+                nowUs += 1000;
+                dueUs = pipe.link.transmit(nowUs, static_cast<size_t>(n));
+            }
+            if (!pipe.queue.empty()) {
+                dueUs = std::max(dueUs, pipe.queue.back().dueUs);
+            }
+            pipe.queue.push_back({ dueUs, std::vector<uint8_t>(buffer, buffer + n), 0 });
+        }
+    }
+
+    // Writes segments that are due; false on error
+    bool flushPipe(Pipe& pipe, int64_t nowUs) {
+        while (!pipe.queue.empty() && pipe.queue.front().dueUs <= nowUs) {
+            Segment& segment = pipe.queue.front();
+            ssize_t n = send(pipe.to, segment.data.data() + segment.offset,
+                segment.data.size() - segment.offset, MSG_NOSIGNAL);
+            if (n < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            segment.offset += static_cast<size_t>(n);
+            if (segment.offset < segment.data.size()) {
+                return true;
+            }
+            pipe.queue.pop_front();
+        }
+        return true;
+    }
+}
+
+static int runTcpProxy(const Scenario& scenario, uint16_t listenPort, const sockaddr_in& target) {
+    int listenFd = bindSocket(SOCK_STREAM, listenPort);
+    if (listenFd < 0) {
+        LOG_ERROR("Could not listen on port %d: %s", listenPort, strerror(errno));
+        return 1;
+    }
+
+    std::vector<Connection> connections;
+    uint64_t accepted = 0;
+    uint64_t refused = 0;
+    uint64_t dropped = 0;
+
+    int64_t startUs = wallMicros();
+    const LinkProfile* profile = nullptr;
+
+    while (g_running) {
+        int64_t nowUs = wallMicros();
+        int64_t elapsedMs = (nowUs - startUs) / 1000;
+        if (elapsedMs >= scenario.durationMs) {
+            break;
+        }
+
+        const LinkProfile* current = &scenario.profileAt(elapsedMs);
+        if (current != profile) {
+            profile = current;
+            for (Connection& connection : connections) {
+                connection.up->link.setProfile(streamProfile(*profile));
+                connection.down->link.setProfile(streamProfile(*profile));
+                if (profile->down) {
+                    connection.closed = true;
+                    dropped++;
+                }
+            }
+        }
+
+        // Write what is due, then retire closed connections
+        for (Connection& connection : connections) {
+            if (!connection.closed &&
+                (!flushPipe(*connection.up, nowUs) || !flushPipe(*connection.down, nowUs))) {
+                connection.closed = true;
+            }
+        }
+        for (size_t i = 0; i < connections.size();) {
+            if (connections[i].closed) {
+                close(connections[i].clientFd);
+                close(connections[i].targetFd);
+                connections[i] = std::move(connections.back());
+                connections.pop_back();
+            }
+            else {
+                i++;
+            }
+        }
+
+        int64_t nextDueUs = nowUs + kMaxPollMs * 1000;
+        std::vector<pollfd> fds;
+        fds.push_back({ listenFd, POLLIN, 0 });
+        for (const Connection& connection : connections) {
+            fds.push_back({ connection.clientFd, POLLIN, 0 });
+            fds.push_back({ connection.targetFd, POLLIN, 0 });
+            for (const Pipe* pipe : { connection.up.get(), connection.down.get() }) {
+                if (!pipe->queue.empty()) {
+                    nextDueUs = std::min(nextDueUs, pipe->queue.front().dueUs);
+                }
+            }
+        }
+
+        int timeoutMs = static_cast<int>(std::max<int64_t>(0, (nextDueUs - nowUs) / 1000));
+        if (poll(fds.data(), fds.size(), timeoutMs) <= 0) {
+            continue;
+        }
+        nowUs = wallMicros();
+
+        for (size_t i = 0; i < connections.size(); i++) {
+            Connection& connection = connections[i];
+            if (connection.closed) {
+                continue;
+            }
+            if ((fds[1 + 2 * i].revents && !readPipe(*connection.up, nowUs)) ||
+                (fds[2 + 2 * i].revents && !readPipe(*connection.down, nowUs))) {
+                connection.closed = true;
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientFd < 0) {
+                continue;
+            }
+            if (profile->down || connections.size() >= kMaxTcpConnections) {
+                close(clientFd);
+                refused++;
+                continue;
+            }
+
+            // Blocking connect: the target is expected to be local
+            int targetFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (targetFd < 0 ||
+                connect(targetFd, reinterpret_cast<const sockaddr*>(&target), sizeof(target)) != 0) {
+                LOG_WARN("Could not reach proxy target: %s", strerror(errno));
+                if (targetFd >= 0) {
+                    close(targetFd);
+                }
+                close(clientFd);
+                refused++;
+                continue;
+            }
+            fcntl(targetFd, F_SETFL, fcntl(targetFd, F_GETFL) | O_NONBLOCK);
+
+            int one = 1;
+            setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            setsockopt(targetFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            // Each connection gets its own, still reproducible, draws
+            uint64_t seed = scenario.seed + accepted * 2;
+            Connection connection;
+            connection.clientFd = clientFd;
+            connection.targetFd = targetFd;
+            connection.up.reset(new Pipe(clientFd, targetFd, seed));
+            connection.down.reset(new Pipe(targetFd, clientFd, seed + 1));
+            connection.up->link.setProfile(streamProfile(*profile));
+            connection.down->link.setProfile(streamProfile(*profile));
+            connection.closed = false;
+            connections.push_back(std::move(connection));
+            accepted++;
+        }
+    }
+
+    for (Connection& connection : connections) {
+        close(connection.clientFd);
+        close(connection.targetFd);
+    }
+    close(listenFd);
+
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "accepted", static_cast<double>(accepted));
+    cJSON_AddNumberToObject(json, "refused", static_cast<double>(refused));
+    cJSON_AddNumberToObject(json, "dropped", static_cast<double>(dropped));
+    printJson(json);
+    return 0;
+}
+
+static void usage() {
+    std::cerr << "usage: netsim simulate <scenario.json>\n"
+        "       netsim udp <listen-port> <target-address> <target-port> <scenario.json>\n"
+        "       netsim tcp <listen-port> <target-address> <target-port> <scenario.json>\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Register signal handlers
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+
+    Logger::instance().start();
+
+    int result = 2;
+    try {
+        std::string mode = argv[1];
+        if (mode == "simulate" && argc == 3) {
+            result = runSimulation(Scenario::loadFromFile(argv[2]));
+        }
+        else if ((mode == "udp" || mode == "tcp") && argc == 6) {
+            sockaddr_in target;
+            int port = atoi(argv[2]);
+            if (port <= 0 || port > 65535 || !parseAddress(argv[3], argv[4], target)) {
+                LOG_ERROR("Invalid proxy address");
+            }
+            else {
+                Scenario scenario = Scenario::loadFromFile(argv[5]);
+                result = mode == "udp" ?
+                    runUdpProxy(scenario, static_cast<uint16_t>(port), target) :
+                    runTcpProxy(scenario, static_cast<uint16_t>(port), target);
+            }
+        }
+        else {
+            usage();
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("Fatal error: %s", e.what());
+        result = 1;
+    }
+
+    Logger::instance().stop();
+    return result;
+}
\ No newline at end of file
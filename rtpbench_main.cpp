@@ -0,0 +1,573 @@
+// src/rtpbench_main.cpp
+//
+// Offline benchmark of the relay send path against captured camera RTP.
+//
+//   rtpbench [--viewers N] [--fec GROUP] [--rounds N] <capture.pcap|.pcapng>
+//
+// Reads the UDP payloads that parse as RTP (Ethernet, Linux cooked, raw
+// IP or loopback link types, IPv4 or IPv6) and times each per-packet
+// stage of RtpRelay on them, in CPU time of the benchmarking thread:
+//
+//   parse     RtpPacketView::parse, once per packet
+//   rewrite   per-viewer fixed header (sequence, timestamp, SSRC)
+//   fec       FlexFEC parity at GROUP packets per repair (0 = off)
+//   egress    sendmmsg of header + shared body to a loopback sink
+//
+// The per-viewer stages are reported per packet and viewer, and with the
+// capture's own packet rate give how many viewers one core can feed.
+// Same capture, same work, so media-path changes can be compared.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "RtpPacket.h"
+#include "FecEncoder.h"
+
+namespace {
+    const size_t kSendBatch = 256;              // As RtpRelay
+    const size_t kMinStagePackets = 200000;     // Repeat short captures
+    const int kSinkBuffer = 4 << 20;
+
+    // Link types (pcap LINKTYPE_*)
+    const uint32_t kLinkNull = 0;
+    const uint32_t kLinkEthernet = 1;
+    const uint32_t kLinkRaw = 101;
+    const uint32_t kLinkLinuxSll = 113;
+    const uint32_t kLinkIpv4 = 228;
+    const uint32_t kLinkIpv6 = 229;
+    const uint32_t kLinkLinuxSll2 = 276;
+
+    // pcapng block types
+    const uint32_t kBlockSectionHeader = 0x0A0D0D0A;
+    const uint32_t kBlockInterface = 1;
+    const uint32_t kBlockSimplePacket = 3;
+    const uint32_t kBlockEnhancedPacket = 6;
+
+    struct Packet {
+        size_t offset;
+        size_t length;
+        uint64_t timestampNs;
+    };
+
+    // Every RTP packet of the capture, back to back
+    struct Capture {
+        std::vector<uint8_t> storage;
+        std::vector<Packet> packets;
+        uint64_t udpPackets = 0;
+    };
+
+    uint16_t readU16(const uint8_t* p, bool swap) {
+        uint16_t value;
+        memcpy(&value, p, 2);
+        return swap ? __builtin_bswap16(value) : value;
+    }
+
+    uint32_t readU32(const uint8_t* p, bool swap) {
+        uint32_t value;
+        memcpy(&value, p, 4);
+        return swap ? __builtin_bswap32(value) : value;
+    }
+
+    // UDP payload of an IP packet, or null
+    const uint8_t* udpFromIp(const uint8_t* p, size_t length, size_t& payloadLength) {
+        if (length < 1) {
+            return nullptr;
+        }
+
+        const uint8_t* udp = nullptr;
+        size_t remaining = 0;
+        int version = p[0] >> 4;
+        if (version == 4 && length >= 20) {
+            size_t headerLength = 4 * (p[0] & 0x0F);
+            size_t totalLength = rtpReadU16(p + 2);
+            bool fragment = (rtpReadU16(p + 6) & 0x3FFF) != 0;
+            if (p[9] != 17 || fragment || headerLength < 20 || totalLength > length ||
+                totalLength < headerLength) {
+                return nullptr;
+            }
+            udp = p + headerLength;
+            remaining = totalLength - headerLength;
+        }
+        else if (version == 6 && length >= 40) {
+            // Extension headers are not followed
+            size_t totalLength = 40 + rtpReadU16(p + 4);
+            if (p[6] != 17 || totalLength > length) {
+                return nullptr;
+            }
+            udp = p + 40;
+            remaining = totalLength - 40;
+        }
+        else {
+            return nullptr;
+        }
+
+        if (remaining < 8) {
+            return nullptr;
+        }
+        size_t udpLength = rtpReadU16(udp + 4);
+        if (udpLength < 8 || udpLength > remaining) {
+            return nullptr;
+        }
+        payloadLength = udpLength - 8;
+        return udp + 8;
+    }
+
+    const uint8_t* udpFromFrame(uint32_t linkType, const uint8_t* p, size_t length,
+        size_t& payloadLength) {
+        switch (linkType) {
+        case kLinkEthernet: {
+            size_t offset = 12;
+            while (offset + 2 <= length) {
+                uint16_t etherType = rtpReadU16(p + offset);
+                if (etherType == 0x8100 || etherType == 0x88A8) {
+                    offset += 4;
+                    continue;
+                }
+                if (etherType != 0x0800 && etherType != 0x86DD) {
+                    return nullptr;
+                }
+                return udpFromIp(p + offset + 2, length - offset - 2, payloadLength);
+            }
+            return nullptr;
+        }
+        case kLinkLinuxSll:
+            return length >= 16 ? udpFromIp(p + 16, length - 16, payloadLength) : nullptr;
+        case kLinkLinuxSll2:
+            return length >= 20 ? udpFromIp(p + 20, length - 20, payloadLength) : nullptr;
+        case kLinkNull:
+            return length >= 4 ? udpFromIp(p + 4, length - 4, payloadLength) : nullptr;
+        case kLinkRaw:
+        case kLinkIpv4:
+        case kLinkIpv6:
+            return udpFromIp(p, length, payloadLength);
+        default:
+            return nullptr;
+        }
+    }
+
+    void addFrame(Capture& capture, uint32_t linkType, const uint8_t* frame, size_t length,
+        uint64_t timestampNs) {
+        size_t payloadLength = 0;
+        const uint8_t* payload = udpFromFrame(linkType, frame, length, payloadLength);
+        if (!payload) {
+            return;
+        }
+        capture.udpPackets++;
+
+        RtpPacketView packet;
+        if (payloadLength > FecEncoder::kMaxPacket || !packet.parse(payload, payloadLength, 0)) {
+            return;
+        }
+        capture.packets.push_back({ capture.storage.size(), payloadLength, timestampNs });
+        capture.storage.insert(capture.storage.end(), payload, payload + payloadLength);
+    }
+
+    bool readClassic(const std::vector<uint8_t>& file, Capture& capture) {
+        uint32_t magic;
+        memcpy(&magic, file.data(), 4);
+        bool swap = magic == 0xD4C3B2A1 || magic == 0x4D3CB2A1;
+        bool nanos = magic == 0xA1B23C4D || magic == 0x4D3CB2A1;
+        if (file.size() < 24) {
+            return false;
+        }
+        uint32_t linkType = readU32(file.data() + 20, swap) & 0x0FFFFFFF;
+
+        size_t offset = 24;
+        while (offset + 16 <= file.size()) {
+            const uint8_t* record = file.data() + offset;
+            uint64_t seconds = readU32(record, swap);
+            uint64_t fraction = readU32(record + 4, swap);
+            size_t captured = readU32(record + 8, swap);
+            if (offset + 16 + captured > file.size()) {
+                break;
+            }
+            uint64_t timestampNs = seconds * 1000000000ull + (nanos ? fraction : fraction * 1000);
+            addFrame(capture, linkType, record + 16, captured, timestampNs);
+            offset += 16 + captured;
+        }
+        return true;
+    }
+
+    bool readPcapng(const std::vector<uint8_t>& file, Capture& capture) {
+        bool swap = false;
+        std::vector<uint32_t> linkTypes;
+        std::vector<uint64_t> ticksPerSecond;
+
+        size_t offset = 0;
+        while (offset + 12 <= file.size()) {
+            const uint8_t* block = file.data() + offset;
+            uint32_t type = readU32(block, swap);
+
+            if (type == kBlockSectionHeader) {
+                // Byte order is per section
+                uint32_t byteOrder;
+                memcpy(&byteOrder, block + 8, 4);
+                swap = byteOrder == 0x4D3C2B1A;
+                linkTypes.clear();
+                ticksPerSecond.clear();
+            }
+
+            uint32_t blockLength = readU32(block + 4, swap);
+            if (blockLength < 12 || blockLength % 4 != 0 || offset + blockLength > file.size()) {
+                break;
+            }
+            const uint8_t* body = block + 8;
+            size_t bodyLength = blockLength - 12;
+
+            if (type == kBlockInterface && bodyLength >= 8) {
+                linkTypes.push_back(readU16(body, swap));
+
+                // if_tsresol: 10^-n, or 2^-n with the top bit set
+                uint64_t ticks = 1000000;
+                for (size_t option = 8; option + 4 <= bodyLength;) {
+                    uint16_t code = readU16(body + option, swap);
+                    uint16_t length = readU16(body + option + 2, swap);
+                    if (code == 0 || option + 4 + length > bodyLength) {
+                        break;
+                    }
+                    if (code == 9 && length >= 1) {
+                        uint8_t resolution = body[option + 4];
+                        ticks = 1;
+                        for (int i = 0; i < (resolution & 0x7F) && ticks < 1000000000000ull; i++) {
+                            ticks *= (resolution & 0x80) ? 2 : 10;
+                        }
+                    }
+                    option += 4 + ((length + 3) & ~3u);
+                }
+                ticksPerSecond.push_back(ticks);
+            }
+            else if (type == kBlockEnhancedPacket && bodyLength >= 20) {
+                uint32_t interface = readU32(body, swap);
+                uint64_t ticks = (static_cast<uint64_t>(readU32(body + 4, swap)) << 32) |
+                    readU32(body + 8, swap);
+                size_t captured = readU32(body + 12, swap);
+                if (interface < linkTypes.size() && 20 + captured <= bodyLength) {
+                    uint64_t perSecond = ticksPerSecond[interface];
+                    uint64_t timestampNs = ticks / perSecond * 1000000000ull +
+                        ticks % perSecond * 1000000000ull / perSecond;
+                    addFrame(capture, linkTypes[interface], body + 20, captured, timestampNs);
+                }
+            }
+            else if (type == kBlockSimplePacket && bodyLength >= 4 && !linkTypes.empty()) {
+                size_t captured = std::min<size_t>(readU32(body, swap), bodyLength - 4);
+                addFrame(capture, linkTypes[0], body + 4, captured, 0);
+            }
+
+            offset += blockLength;
+        }
+        return true;
+    }
+
+    bool readCapture(const char* path, Capture& capture) {
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            return false;
+        }
+
+        std::vector<uint8_t> contents;
+        uint8_t chunk[65536];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            contents.insert(contents.end(), chunk, chunk + n);
+        }
+        fclose(file);
+
+        if (contents.size() < 4) {
+            return false;
+        }
+        uint32_t magic;
+        memcpy(&magic, contents.data(), 4);
+        if (magic == kBlockSectionHeader) {
+            return readPcapng(contents, capture);
+        }
+        if (magic == 0xA1B2C3D4 || magic == 0xD4C3B2A1 || magic == 0xA1B23C4D || magic == 0x4D3CB2A1) {
+            return readClassic(contents, capture);
+        }
+        return false;
+    }
+
+    uint64_t threadCpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+    }
+
+    // Loopback receiver, drained on its own thread so the sender sees a
+    // real delivery cost rather than a full buffer
+    class Sink {
+    public:
+        Sink() : fd(-1), running(false) {}
+
+        ~Sink() {
+            running = false;
+            if (drainer.joinable()) {
+                drainer.join();
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        bool open() {
+            fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return false;
+            }
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &kSinkBuffer, sizeof(kSinkBuffer));
+
+            timeval timeout = { 0, 100000 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+                return false;
+            }
+
+            running = true;
+            drainer = std::thread([this]() {
+                uint8_t buffer[FecEncoder::kMaxPacket];
+                while (running) {
+                    recv(fd, buffer, sizeof(buffer), 0);
+                }
+            });
+            return true;
+        }
+
+        sockaddr_in address;
+
+    private:
+        int fd;
+        std::atomic<bool> running;
+        std::thread drainer;
+    };
+
+    struct StageResult {
+        const char* name;
+        double nsPerUnit;
+    };
+}
+
+static void usage() {
+    std::cerr << "usage: rtpbench [--viewers N] [--fec GROUP] [--rounds N] <capture.pcap|.pcapng>\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t viewers = 16;
+    int fecGroup = 5;
+    size_t rounds = 0;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--viewers") == 0 && i + 1 < argc) {
+            viewers = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--fec") == 0 && i + 1 < argc) {
+            fecGroup = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (!path || viewers == 0 || fecGroup < 0) {
+        usage();
+        return 2;
+    }
+
+    Capture capture;
+    if (!readCapture(path, capture)) {
+        std::cerr << "Could not read capture " << path << "\n";
+        return 1;
+    }
+    if (capture.packets.empty()) {
+        std::cerr << "No RTP in " << capture.udpPackets << " UDP packets of " << path << "\n";
+        return 1;
+    }
+
+    const std::vector<Packet>& packets = capture.packets;
+    const uint8_t* storage = capture.storage.data();
+    if (rounds == 0) {
+        rounds = (kMinStagePackets + packets.size() - 1) / packets.size();
+    }
+
+    // Stream rate from the capture timestamps
+    double seconds = (packets.back().timestampNs - packets.front().timestampNs) / 1e9;
+    double packetRate = seconds > 0.0 ? (packets.size() - 1) / seconds : 0.0;
+
+    std::vector<StageResult> results;
+    volatile uint32_t consumed = 0;             // Keeps the work observable
+
+    // Parse
+    {
+        uint32_t sum = 0;
+        uint64_t start = threadCpuNanos();
+        for (size_t round = 0; round < rounds; round++) {
+            for (const Packet& packet : packets) {
+                RtpPacketView view;
+                if (view.parse(storage + packet.offset, packet.length, 0)) {
+                    sum += view.seq;
+                }
+            }
+        }
+        consumed = sum;
+        results.push_back({ "parse", double(threadCpuNanos() - start) / (rounds * packets.size()) });
+    }
+
+    // Per-viewer header rewrite, as RtpRelay::select on a steady stream
+    std::vector<uint8_t> headers(viewers * RtpPacketView::kFixedHeaderSize);
+    {
+        uint32_t sum = 0;
+        uint64_t start = threadCpuNanos();
+        for (size_t round = 0; round < rounds; round++) {
+            for (const Packet& packet : packets) {
+                const uint8_t* data = storage + packet.offset;
+                uint16_t seq = rtpReadU16(data + 2);
+                uint32_t timestamp = rtpReadU32(data + 4);
+                for (size_t v = 0; v < viewers; v++) {
+                    uint8_t* header = &headers[v * RtpPacketView::kFixedHeaderSize];
+                    memcpy(header, data, RtpPacketView::kFixedHeaderSize);
+                    rtpWriteU16(header + 2, static_cast<uint16_t>(seq + v));
+                    rtpWriteU32(header + 4, timestamp + static_cast<uint32_t>(v));
+                    rtpWriteU32(header + 8, 0x52454C00u + static_cast<uint32_t>(v));
+                }
+                sum += headers[2];
+            }
+        }
+        consumed = sum;
+        results.push_back({ "rewrite", double(threadCpuNanos() - start) / (rounds * packets.size() * viewers) });
+    }
+
+    // FlexFEC parity per viewer
+    if (fecGroup > 0) {
+        std::vector<std::unique_ptr<FecEncoder>> encoders;
+        for (size_t v = 0; v < viewers; v++) {
+            encoders.emplace_back(new FecEncoder(0x52454C00u + static_cast<uint32_t>(v),
+                0x46454300u + static_cast<uint32_t>(v), 118));
+            encoders.back()->setGroupSize(fecGroup);
+        }
+        std::vector<uint8_t> repair(FecEncoder::kMaxPacket);
+
+        size_t repairs = 0;
+        uint64_t start = threadCpuNanos();
+        for (size_t round = 0; round < rounds; round++) {
+            for (const Packet& packet : packets) {
+                const uint8_t* data = storage + packet.offset;
+                for (size_t v = 0; v < viewers; v++) {
+                    repairs += encoders[v]->protect(data,
+                        data + RtpPacketView::kFixedHeaderSize,
+                        packet.length - RtpPacketView::kFixedHeaderSize, repair.data()) > 0;
+                }
+            }
+        }
+        consumed = static_cast<uint32_t>(repairs);
+        results.push_back({ "fec", double(threadCpuNanos() - start) / (rounds * packets.size() * viewers) });
+    }
+
+    // Egress: one sendmmsg per batch, header and shared body per message
+    Sink sink;
+    int sendFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sendFd < 0 || !sink.open()) {
+        std::cerr << "Could not open loopback sockets\n";
+        return 1;
+    }
+    setsockopt(sendFd, SOL_SOCKET, SO_SNDBUF, &kSinkBuffer, sizeof(kSinkBuffer));
+
+    uint64_t sendFailures = 0;
+    {
+        std::vector<mmsghdr> messages(kSendBatch);
+        std::vector<iovec> vectors(kSendBatch * 2);
+        size_t pending = 0;
+
+        auto flush = [&]() {
+            size_t offset = 0;
+            while (offset < pending) {
+                int sent = sendmmsg(sendFd, &messages[offset], static_cast<unsigned int>(pending - offset), 0);
+                if (sent <= 0) {
+                    sendFailures += pending - offset;
+                    break;
+                }
+                offset += sent;
+            }
+            pending = 0;
+        };
+
+        // Each send is a syscall per batch; scale rounds down to keep the
+        // run short
+        size_t egressRounds = std::max<size_t>(1, rounds / viewers);
+        uint64_t start = threadCpuNanos();
+        for (size_t round = 0; round < egressRounds; round++) {
+            for (const Packet& packet : packets) {
+                uint8_t* data = capture.storage.data() + packet.offset;
+                for (size_t v = 0; v < viewers; v++) {
+                    iovec* vector = &vectors[pending * 2];
+                    vector[0].iov_base = &headers[v * RtpPacketView::kFixedHeaderSize];
+                    vector[0].iov_len = RtpPacketView::kFixedHeaderSize;
+                    vector[1].iov_base = data + RtpPacketView::kFixedHeaderSize;
+                    vector[1].iov_len = packet.length - RtpPacketView::kFixedHeaderSize;
+
+                    msghdr& message = messages[pending].msg_hdr;
+                    memset(&message, 0, sizeof(message));
+                    message.msg_name = &sink.address;
+                    message.msg_namelen = sizeof(sink.address);
+                    message.msg_iov = vector;
+                    message.msg_iovlen = 2;
+
+                    if (++pending == kSendBatch) {
+                        flush();
+                    }
+                }
+            }
+        }
+        flush();
+        results.push_back({ "egress", double(threadCpuNanos() - start) / (egressRounds * packets.size() * viewers) });
+    }
+    close(sendFd);
+
+    // Report
+    double perPacket = results[0].nsPerUnit;
+    double perViewer = 0.0;
+    for (size_t i = 1; i < results.size(); i++) {
+        perViewer += results[i].nsPerUnit;
+    }
+
+    std::cout << path << ": " << packets.size() << " RTP packets of " << capture.udpPackets
+        << " UDP, " << std::fixed << std::setprecision(1) << packetRate << " packets/s\n";
+    std::cout << viewers << " viewers, FEC " << (fecGroup > 0 ? std::to_string(fecGroup) : "off")
+        << ", " << rounds << " rounds\n\n";
+    std::cout << "  parse    " << std::setw(8) << perPacket << " ns/packet\n";
+    for (size_t i = 1; i < results.size(); i++) {
+        std::cout << "  " << std::left << std::setw(8) << results[i].name << std::right << " "
+            << std::setw(8) << results[i].nsPerUnit << " ns/packet/viewer\n";
+    }
+    if (sendFailures > 0) {
+        std::cout << "  (" << sendFailures << " sends failed)\n";
+    }
+
+    // A core spends parse once per packet and the rest once per viewer
+    if (packetRate > 0.0 && perViewer > 0.0) {
+        double budget = 1e9 / packetRate - perPacket;
+        std::cout << "\nsustainable viewers per core: " << std::setprecision(0)
+            << std::max(0.0, budget / perViewer) << "\n";
+    }
+
+    (void)consumed;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// src/server_main.cpp
+#include <iostream>
+#include <csignal>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <sys/resource.h>
+
+#include "SignalingServer.h"
+#include "Logger.h"
+#include "MemoryAccounting.h"
+
+// Global signal handling
+namespace {
+    std::atomic<bool> g_running(true);
+}
+
+void signalHandler(int signum) {
+    std::cout << "Interrupt signal (" << signum << ") received.\n";
+    g_running = false;
+}
+
+// Every idle device holds a socket, so lift the descriptor limit first
+static void raiseFileLimit(rlim_t wanted) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return;
+    }
+
+    limit.rlim_cur = (limit.rlim_max == RLIM_INFINITY || wanted < limit.rlim_max) ?
+        wanted : limit.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        LOG_WARN("Could not raise RLIMIT_NOFILE");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Register signal handlers
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Before anything touches cJSON or libwebsockets
+    MemoryAccounting::install();
+
+    SignalingServerConfig config;
+    if (argc > 1) {
+        config.port = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        config.serviceThreads = static_cast<unsigned int>(atoi(argv[2]));
+    }
+
+    Logger::instance().start();
+    raiseFileLimit(config.maxConnections + 1024);
+
+    try {
+        SignalingServer server(config);
+        server.start();
+
+        LOG_INFO("Signaling server listening on port %d", config.port);
+
+        int ticks = 0;
+        while (g_running && server.isRunning()) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+
+            // Periodic occupancy report
+            if (++ticks % 10 == 0) {
+                LOG_INFO("devices=%zu viewers=%zu queues=%zuB json=%zuB websocket=%zuB",
+                    server.deviceCount(), server.viewerCount(),
+                    MemoryAccounting::current(MemoryTag::QUEUES),
+                    MemoryAccounting::current(MemoryTag::JSON),
+                    MemoryAccounting::current(MemoryTag::WEBSOCKET));
+            }
+        }
+
+        server.stop();
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("Fatal error: %s", e.what());
+        Logger::instance().stop();
+        return 1;
+    }
+
+    Logger::instance().stop();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+// src/sigreplay_main.cpp
+//
+// Replays signaling captures through SignalingClient's receive path.
+//
+//   sigreplay [--speed N] <capture>...
+//
+// Inbound frames are deserialized and dispatched exactly as the event
+// loop would, with reliable delivery on as on a device. --speed 1 (the
+// default) keeps the recorded spacing, N > 1 compresses it, and 0 feeds
+// frames back to back to benchmark the handlers. Outbound frames are
+// counted but not replayed. Pass rotated files oldest first.
+#include <iostream>
+#include <csignal>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "SignalingClient.h"
+#include "SignalingCapture.h"
+#include "Logger.h"
+#include "MemoryAccounting.h"
+
+// Global signal handling
+namespace {
+    std::atomic<bool> g_running(true);
+
+    // The client is never connected; the URL only names the context
+    const char* kReplayUrl = "127.0.0.1";
+
+    int64_t percentile(std::vector<int64_t>& values, double fraction) {
+        if (values.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(fraction * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+}
+
+void signalHandler(int signum) {
+    std::cerr << "Interrupt signal (" << signum << ") received.\n";
+    g_running = false;
+}
+
+static void usage() {
+    std::cerr << "usage: sigreplay [--speed N] <capture>...\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Register signal handlers
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    double speed = 1.0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        }
+        else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty() || speed < 0.0) {
+        usage();
+        return 2;
+    }
+
+    // Before anything touches cJSON or libwebsockets
+    MemoryAccounting::install();
+    Logger::instance().start();
+
+    std::map<std::string, uint64_t> dispatched;
+    uint64_t inbound = 0;
+    uint64_t outbound = 0;
+    std::vector<int64_t> handlerNs;
+    int64_t maxLagNs = 0;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point started = Clock::now();
+
+    try {
+        SignalingClient client(kReplayUrl);
+        client.setReliableDelivery(true);
+        client.setMessageCallback([&dispatched](const SignalingMessage& message) {
+            dispatched[signalingMessageTypeToString(message.getType())]++;
+        });
+
+        for (const std::string& path : paths) {
+            SignalingCaptureReader reader;
+            if (!reader.open(path)) {
+                LOG_ERROR("Could not read capture %s", path);
+                Logger::instance().stop();
+                return 1;
+            }
+
+            // Timestamps restart with each recorded process, so pace each
+            // file from its own first record
+            Clock::time_point fileStart = Clock::now();
+            uint64_t firstNs = 0;
+            bool first = true;
+
+            SignalingCaptureReader::Record record;
+            while (g_running && reader.next(record)) {
+                if (record.direction == SignalingCapture::OUTBOUND) {
+                    outbound++;
+                    continue;
+                }
+                if (first) {
+                    firstNs = record.timestampNs;
+                    first = false;
+                }
+
+                if (speed > 0.0) {
+                    uint64_t offsetNs = record.timestampNs > firstNs ? record.timestampNs - firstNs : 0;
+                    Clock::time_point due = fileStart +
+                        std::chrono::nanoseconds(static_cast<int64_t>(offsetNs / speed));
+                    std::this_thread::sleep_until(due);
+                    maxLagNs = std::max<int64_t>(maxLagNs,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count());
+                }
+
+                Clock::time_point before = Clock::now();
+                client.replayFrame(record.data, record.length);
+                handlerNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - before).count());
+                inbound++;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("Fatal error: %s", e.what());
+        Logger::instance().stop();
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+    int64_t totalNs = 0;
+    for (int64_t ns : handlerNs) {
+        totalNs += ns;
+    }
+
+    std::cout << "replayed " << inbound << " inbound frames (" << outbound
+        << " outbound skipped) in " << elapsed << " s\n";
+    if (inbound > 0) {
+        std::cout << "handler: " << (totalNs > 0 ? inbound * 1e9 / totalNs : 0.0) << " msg/s"
+            << ", p50 " << percentile(handlerNs, 0.50) / 1000.0 << " us"
+            << ", p99 " << percentile(handlerNs, 0.99) / 1000.0 << " us"
+            << ", max " << percentile(handlerNs, 1.0) / 1000.0 << " us\n";
+    }
+    if (speed > 0.0) {
+        std::cout << "max lag behind schedule: " << maxLagNs / 1e6 << " ms\n";
+    }
+    for (const auto& entry : dispatched) {
+        std::cout << "  " << entry.first << ": " << entry.second << "\n";
+    }
+
+    Logger::instance().stop();
+    return 0;
+}
\ No newline at end of file